@@ -4,6 +4,9 @@
 
 #include <algorithm>
 #include <chrono>
+#include <climits>
+#include <deque>
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -11,14 +14,22 @@
 #include <random>
 #include <set>
 #include <string>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <vector>
 
 using namespace std;
 
 uint64_t BYTES; // space used atm
-uint64_t L0_HASH_BYTES; // space used atm
-uint64_t GENERATING_L0_HASH_TIME; // space used atm
-int P=1073741789; // >2^30
+uint64_t L0_HASH_BYTES; // space used by the hashes of the samplers
+uint64_t GENERATING_L0_HASH_TIME; // time to generate the hashes of the samplers
+bool USE_IBLT=false; // s-sparse recovery by peeling an IBLT of IBLT_CELLS*s cells in IBLT_ROWS rows
+int IBLT_ROWS=3;
+double IBLT_CELLS=1.3;
+int BATCH_SIZE=65536; // edge updates collected before being applied sampler by sampler, 0 applies each update as it arrives
+string SKETCH_FILE=""; // if set the sampler bank is a shared mapping of this file rather than memory, so it can be larger than RAM (see benchmark_out_of_core)
+size_t WRITEBACK_BYTES=64*1024*1024; // bytes of each counter array swept before write-back of the dirty pages behind the sweep is started
+uint64_t SKETCH_BYTES; // size of the sampler bank of the last pass
 
 /*-----------------*
  * DATA STRUCTURES *
@@ -33,36 +44,52 @@ struct edge { // undirected edge
   int value;
 };
 
-struct hash_params { // parameters for hash function
-  unsigned long a;
-  unsigned long b;
-  unsigned long m;
+struct sampler_hash { // multiply-shift parameters taking the 128-bit hash of an edge id to the hashes of one sampler
+  uint64_t a_lo, a_hi, a_b; // unique hash (chooses levels & min hash edge)
+  uint64_t c_lo, c_hi, c_b; // col hash (16 bits per row)
+};
+
+struct sampler_bank { // counters of every sampler, [sampler][s-sparse][s-sparse col][s-sparse row] flattened
+  long* phi; // sum of weights (sum ai)
+  long* iota; // weighted sum of weights (sum ai*i), follows phi in the same mapping
+  size_t cells; // counters in each of phi & iota
+  int fd; // backing file, -1 if the bank is in memory
 };
 
 void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, string edge_file_path, string vertex_file_path, string out_file);
+void benchmark_out_of_core(int c, int d, int n, string edge_file_path, string vertex_file_path, int reps, string sketch_file, string out_file);
 
 // Main algorithm
 void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, set<vertex>& neighbourhood, vertex& root);
 
 // L0 Stream
-void initialise_l0_sampler_counters(int num_samplers, int j, int num_cols, int num_rows, long****& phi_s, long****& iota_s);
-void free_l0_sampler_counters(int num_samplers, int j, int num_cols, int num_rows, long**** phi_s, long**** iota_s);
+bool initialise_sampler_bank(sampler_bank& bank, int num_samplers, int j, int num_cols, int num_rows);
+void free_sampler_bank(sampler_bank& bank);
+inline size_t bank_level(int i, int k, int j, int num_cells);
+void apply_edge_batch(vector<pair<uint64_t,int>>& batch, int num_samplers, int j, int num_cols, int num_rows, uint64_t seed, vector<sampler_hash>& ps_s, sampler_bank& bank);
+void write_back(sampler_bank& bank, size_t start, size_t end);
 
 // s-sparse
-hash_params* choose_hash_functions(int num_cols, int num_rows);
-void update_s_sparse(uint64_t endpoint, int edge_value, int num_rows, hash_params* ps_s, long** phi_s, long** iota_s);
-set<uint64_t> recover_neighbourhood(int num_cols, int num_rows, long** phi_s, long** iota_s);
-uint64_t recover_id(set<uint64_t> neighbourhood, int sparsity, uint64_t* hash_map);
+void update_s_sparse(uint64_t endpoint, int edge_value, int num_rows, int* cols, long* phi, long* iota);
+set<uint64_t> recover_neighbourhood(int num_cols, int num_rows, long* phi, long* iota);
+uint64_t recover_id(set<uint64_t> neighbourhood, int sparsity, uint64_t seed, sampler_hash ps);
+
+// IBLT
+void iblt_geometry(int s, int& num_cols, int& num_rows);
+set<uint64_t> peel_iblt(int num_cols, int num_rows, uint64_t seed, sampler_hash ps, long* phi_s, long* iota_s, bool& complete);
 
 // 1-sparse
 bool verify_1_sparse(int phi,int iota);
-void update_1_sparse_counters(uint64_t index,int delta,int row,int col,long** phi_s,long** iota_s);
+void update_1_sparse_counters(uint64_t index,int delta,int cell,long* phi,long* iota);
 
 // Hashing
-hash_params generate_hash(int m);
-int hash_function(int key, hash_params ps);
-// n = num keys, m=possible hash values, hash=map from key to hash value
-uint64_t* generate_random_hash(int n, uint64_t m);
+// one 128-bit hash (lo,hi) of an edge id per update, expanded to every sampler by multiply-shift
+uint64_t mix_64(uint64_t x);
+void hash_128(uint64_t x, uint64_t seed, uint64_t& lo, uint64_t& hi);
+sampler_hash generate_sampler_hash(mt19937_64& generator);
+inline uint64_t multiply_shift(uint64_t lo, uint64_t hi, uint64_t a_lo, uint64_t a_hi, uint64_t b);
+inline uint64_t sampler_unique_hash(uint64_t lo, uint64_t hi, sampler_hash& ps);
+void sampler_cols(uint64_t lo, uint64_t hi, sampler_hash& ps, int num_rows, int num_cols, int* cols);
 
 // Utility
 uint64_t edge_id(string str, int num_vertices);
@@ -71,9 +98,7 @@ bool edge_type(string str);
 void parse_vertex(string str, vertex& v);
 int identify_endpoint(edge e,vertex target);
 long*** initalise_zero_3d_array(int depth, int num_cols, int num_rows);
-hash_params** initalise_2d_hash_params_array(int num_cols, int num_rows);
 void free_3d_long_array(long*** arr, int depth, int num_cols, int num_rows);
-void free_2d_hash_params_array(hash_params** arr, int num_cols, int num_rows);
 double variance(vector<uint64_t> vals);
 uint64_t mean(vector<uint64_t> vals);
 
@@ -93,6 +118,9 @@ int main() {
   out_file="edge_sampled_better_id_2.csv";
   execute_test(2,2,1,reps,d,num_vertices,edge_file_path,vertex_file_path,out_file);
 
+  // compare a pass with the sampler bank in memory & mapped from a file
+  //benchmark_out_of_core(2,d,num_vertices,edge_file_path,vertex_file_path,reps,"sampler_bank.bin","out_of_core_benchmark.csv");
+
   //set<vertex> neighbourhood; vertex root; // variables for returned values
   //int c=2;
   //single_pass_insertion_deletion_stream(c,d,num_vertices,edge_file_path,vertex_file_path,neighbourhood,root);
@@ -100,7 +128,7 @@ int main() {
 
 void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, string edge_file_path, string vertex_file_path, string out_file) {
   ofstream outfile(out_file);
-  outfile<<"name,"<<vertex_file_path<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"repetitions,"<<reps<<endl<<"delta,0.2"<<endl<<"gamma,0.3"<<endl<<"sample size,((num_vertices*d)/((double)c))*(1/((double)x)+1/((double)c))*2*log(num_vertices)"<<endl<<endl; // test details
+  outfile<<"name,"<<vertex_file_path<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"repetitions,"<<reps<<endl<<"delta,0.2"<<endl<<"gamma,0.3"<<endl<<"sample size,((num_vertices*d)/((double)c))*(1/((double)x)+1/((double)c))*2*log(num_vertices)"<<endl<<"batch size,"<<BATCH_SIZE<<endl<<"sketch file,"<<SKETCH_FILE<<endl<<endl; // test details
   outfile<<"c,time (microseconds), generating l0 hash time (microseconds) ,mean max space (bytes), l0 hash space (bytes), variance time, variance hash time, variance max space, variance hash space,successes"<<endl; // headers
   set<vertex> neighbourhood; vertex root; // variables for returned values
   vector<uint64_t> times, total_space, hash_times, hash_space; // results of each run of c
@@ -150,6 +178,37 @@ void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, stri
   outfile.close();
 }
 
+// mean time of a pass with the sampler bank in memory & in sketch_file, the slowdown is the cost of running out of core
+// (only a cost once the bank is larger than the page cache, below that the file's pages stay cached)
+void benchmark_out_of_core(int c, int d, int n, string edge_file_path, string vertex_file_path, int reps, string sketch_file, string out_file) {
+  string old_sketch_file=SKETCH_FILE;
+  set<vertex> neighbourhood; vertex root;
+
+  ofstream outfile(out_file);
+  outfile<<"name,"<<edge_file_path<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"c,"<<c<<endl<<"repetitions,"<<reps<<endl<<"batch size,"<<BATCH_SIZE<<endl;
+  outfile<<"sampler bank,time (microseconds),sampler bank (bytes),slowdown,successes"<<endl; // headers
+  double memory_time=0;
+  for (int in_file=0; in_file<2; in_file++) {
+    SKETCH_FILE=(in_file) ? sketch_file : "";
+    vector<uint64_t> times; int successes=0;
+    for (int i=0; i<reps; i++) {
+      BYTES=0; L0_HASH_BYTES=0; GENERATING_L0_HASH_TIME=0;
+      neighbourhood.clear();
+      time_point before=chrono::high_resolution_clock::now();
+      single_pass_insertion_deletion_stream(c,d,n,edge_file_path,vertex_file_path,neighbourhood,root);
+      time_point after=chrono::high_resolution_clock::now();
+      times.push_back(chrono::duration_cast<chrono::microseconds>(after-before).count());
+      if (neighbourhood.size()!=0) successes+=1;
+    }
+    uint64_t mean_time=mean(times);
+    if (!in_file) memory_time=mean_time;
+    cout<<endl<<((in_file) ? "FILE " : "MEMORY ")<<mean_time<<"us"<<endl;
+    outfile<<((in_file) ? sketch_file : "memory")<<","<<mean_time<<","<<SKETCH_BYTES<<","<<mean_time/memory_time<<","<<successes<<endl;
+  }
+  outfile.close();
+  SKETCH_FILE=old_sketch_file;
+}
+
 /*----------------*
  * MAIN ALGORITHM *
  *----------------*/
@@ -171,39 +230,34 @@ void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, strin
   int j=log2(possible_edges); // number of s-sparse recoveries to run
   int num_cols=2*s;
   int num_rows=log(s/gamma);
+  if (USE_IBLT) iblt_geometry(s,num_cols,num_rows);
 
   cout<<"Sparsity of s-sparse:"<<s<<endl<<"# s-sparse per L0:"<<j<<endl<<"# cols per s-sparse:"<<num_cols<<endl<<"# rows per s-sparse:"<<num_rows<<endl;
 
   // allocate space for counters
-  long**** phi_s; long**** iota_s;
+  sampler_bank bank;
   cout<<"ALLOCATING COUNTERS"<<endl;
-  initialise_l0_sampler_counters(total_samplers,j,num_cols,num_rows,phi_s,iota_s);
+  if (!initialise_sampler_bank(bank,total_samplers,j,num_cols,num_rows)) {
+    cout<<"\rFAILED to allocate sampler bank of "<<SKETCH_BYTES<<" bytes"<<endl;
+    neighbourhood.clear();
+    return;
+  }
   cout<<"\rDONE                                             "<<endl; // spaces to "clear" line
+  int num_cells=num_cols*num_rows;
 
-  // generate unique_hash_map for each sampler
+  // generate multiply-shift parameters for each sampler, an edge id is hashed once per update with seed & every sampler's
+  // unique hash & cols are taken from that, so the hashes of a sampler are 6 words rather than a map over every possible edge
+  // (which kept the resident set far above the mapped bank) & level k keeps ids with unique hash <2^(63-k) (no n^3 range to overflow)
   time_point before=chrono::high_resolution_clock::now(); // time before execution
-  uint64_t** unique_hash_maps=(uint64_t**) malloc(total_samplers * sizeof(uint64_t*));
-  uint64_t n3=pow(possible_edges,3);
-  cout<<"possible_edges="<<possible_edges<<", n3="<<n3<<endl;
-  for (int i=0; i<total_samplers; i++) {
-    if (i%1==0) cout<<"\r"<<i;
-    uint64_t* hash_map=generate_random_hash(possible_edges,n3);
-    unique_hash_maps[i]=hash_map;
-  }
-  time_point after=chrono::high_resolution_clock::now(); // time before execution
+  mt19937_64 generator(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+  uint64_t seed=generator();
+  vector<sampler_hash> ps_s(total_samplers);
+  for (int i=0; i<total_samplers; i++) ps_s[i]=generate_sampler_hash(generator);
+  L0_HASH_BYTES=total_samplers*sizeof(sampler_hash);
+  BYTES+=L0_HASH_BYTES;
+  time_point after=chrono::high_resolution_clock::now(); // time after execution
   GENERATING_L0_HASH_TIME=chrono::duration_cast<chrono::microseconds>(after-before).count();
 
-  // generate hashs for s-sparse recovery
-  hash_params*** ps_s=(hash_params***) malloc(total_samplers*sizeof(hash_params**));
-  for (int i=0; i<total_samplers; i++) {
-    ps_s[i]=initalise_2d_hash_params_array(j,num_rows); // each col is for one s-sparse recovery
-    for (int k=0; k<j; k++) ps_s[i][k]=choose_hash_functions(num_cols,num_rows);
-  }
-
-  // hash limits for each value of j
-  uint64_t* hash_lims=new uint64_t[j];
-  for (int i=1; i<=j; i++) hash_lims[i]=n3/pow(2,i);
-
   int sparsity_estimate=0;
 
   ifstream edge_stream(edge_file_path);
@@ -212,6 +266,8 @@ void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, strin
   int edge_counter=0;
   int edge_value;
   uint64_t id;
+  vector<pair<uint64_t,int>> batch; // (edge id, edge value) of updates not yet passed to samplers
+  batch.reserve(BATCH_SIZE);
   while (getline(edge_stream,line)) {
     edge_counter+=1;
     if (edge_counter%1000==0) cout<<"\r"<<edge_counter;
@@ -221,14 +277,10 @@ void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, strin
     sparsity_estimate+=edge_value;
     //cout<<line<<" "<<id<<" ("<<edge_value<<")"<<endl;
 
-    for (int i=0; i<total_samplers; i++) { // pass to samplers
-      uint64_t h=unique_hash_maps[i][id];
-      for (int k=0; k<j; k++) if (h<=hash_lims[k]) {
-        update_s_sparse(id,edge_value,num_rows,ps_s[i][k],phi_s[i][k],iota_s[i][k]);
-      }
-    }
-
+    batch.push_back(make_pair(id,edge_value));
+    if (batch.size()>=BATCH_SIZE) apply_edge_batch(batch,total_samplers,j,num_cols,num_rows,seed,ps_s,bank); // pass to samplers
   }
+  apply_edge_batch(batch,total_samplers,j,num_cols,num_rows,seed,ps_s,bank); // rest of stream
   cout<<"\rDONE                                             "<<endl; // spaces to "clear" line
 
   // recover from each sampler
@@ -237,11 +289,18 @@ void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, strin
   int j_sample=log2(sparsity_estimate)-1;
   cout<<"j_sample="<<j_sample<<endl;
 
+  // samplers are recovered in bank order so a mapped bank is streamed through once
+  if (bank.fd!=-1) madvise(bank.phi,2*bank.cells*sizeof(long),MADV_SEQUENTIAL);
   for (int i=0; i<total_samplers; i++) {
-    cout<<"\r"<<i<<"/"<<total_samplers<<"   "<<phi_s[i][j_sample][0][0]<<","<<iota_s[i][j_sample][0][0];
-    sampled_neighbourhood=recover_neighbourhood(num_cols,num_rows,phi_s[i][j_sample],iota_s[i][j_sample]);
+    size_t level=bank_level(i,j_sample,j,num_cells);
+    cout<<"\r"<<i<<"/"<<total_samplers<<"   "<<bank.phi[level]<<","<<bank.iota[level];
+    if (USE_IBLT) {
+      bool complete;
+      sampled_neighbourhood=peel_iblt(num_cols,num_rows,seed,ps_s[i],bank.phi+level,bank.iota+level,complete);
+      if (!complete) sampled_neighbourhood.clear(); // min hash of a partial recovery is not uniform
+    } else sampled_neighbourhood=recover_neighbourhood(num_cols,num_rows,bank.phi+level,bank.iota+level);
     cout<<"*";
-    uint64_t sampled_id=recover_id(sampled_neighbourhood,s,unique_hash_maps[i]);
+    uint64_t sampled_id=recover_id(sampled_neighbourhood,s,seed,ps_s[i]);
     cout<<"*";
     if (sampled_id!=-1) {
       successes+=1;
@@ -251,6 +310,7 @@ void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, strin
   }
   cout<<"\rDONE                 "<<endl;
   cout<<sampled_ids.size()<<"/"<<successes<<"/"<<total_samplers<<endl;
+  free_sampler_bank(bank);
 
   // check for sufficient neighbourhood
   map<vertex, vector<vertex>> neighbourhoods;
@@ -302,68 +362,109 @@ void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, strin
  * L0 Stream *
  *-----------*/
 
-// allocates space for the counters used for 1-sparse recovery
-// long**** = [sampler][s-sparse][s-sparse col][s-sparse row]
-void initialise_l0_sampler_counters(int num_samplers, int j, int num_cols, int num_rows, long****& phi_s, long****& iota_s) {
-  // prepare pointers
-  phi_s =(long****) malloc(num_samplers*sizeof(long***));
-  iota_s=(long****) malloc(num_samplers*sizeof(long***));
+// allocates zeroed counters used for 1-sparse recovery, in memory or (if SKETCH_FILE is set) in a sparse file which is mapped
+// so only the pages being updated need to be resident, false if the bank cannot be allocated
+bool initialise_sampler_bank(sampler_bank& bank, int num_samplers, int j, int num_cols, int num_rows) {
+  bank.cells=(size_t)num_samplers*j*num_cols*num_rows;
+  SKETCH_BYTES=2*bank.cells*sizeof(long);
+  bank.fd=-1;
+  if (SKETCH_FILE=="") {
+    bank.phi=(long*) calloc(2*bank.cells,sizeof(long));
+    if (bank.phi==nullptr) return false;
+  } else {
+    bank.fd=open(SKETCH_FILE.c_str(),O_RDWR|O_CREAT|O_TRUNC,0644);
+    if (bank.fd==-1) return false;
+    void* ptr=(ftruncate(bank.fd,SKETCH_BYTES)==0) ? mmap(nullptr,SKETCH_BYTES,PROT_READ|PROT_WRITE,MAP_SHARED,bank.fd,0) : MAP_FAILED; // file is zero until written
+    if (ptr==MAP_FAILED) {
+      close(bank.fd);
+      return false;
+    }
+    bank.phi=(long*) ptr;
+  }
+  bank.iota=bank.phi+bank.cells;
+  return true;
+}
 
-  for (int i=0; i<num_samplers; i++) {
-    if (i%100==0) cout<<"\r"<<i;
-    try{
-      phi_s[i] =initalise_zero_3d_array(j,num_cols,num_rows); // sum of weights (sum ai)
-      iota_s[i]=initalise_zero_3d_array(j,num_cols,num_rows); // weighted sum of weights (sum ai*i)
-    } catch (const exception &e) { cout<<"1,"<<e.what()<<endl; }
+// free space used for counters, a mapped bank is unmapped (dirty pages are written back by the kernel) & its file removed
+void free_sampler_bank(sampler_bank& bank) {
+  if (bank.fd==-1) {
+    free(bank.phi);
+    return;
   }
+  munmap(bank.phi,2*bank.cells*sizeof(long));
+  close(bank.fd);
+  unlink(SKETCH_FILE.c_str());
 }
 
-// free space used for counters
-void free_l0_sampler_counters(int num_samplers, int j, int num_cols, int num_rows, long**** phi_s, long**** iota_s) {
+// index of the first counter of s-sparse k of sampler i
+inline size_t bank_level(int i, int k, int j, int num_cells) {
+  return ((size_t)i*j+k)*num_cells;
+}
+
+// pass a batch of updates to every sampler, sampler by sampler in bank order so each page of the bank is loaded & dirtied
+// once per batch rather than once per update, & a mapped bank is written back sequentially as the sweep passes over it
+// each id is hashed once per batch, levels are nested so a sampler stops at the first level which does not keep the id
+void apply_edge_batch(vector<pair<uint64_t,int>>& batch, int num_samplers, int j, int num_cols, int num_rows, uint64_t seed, vector<sampler_hash>& ps_s, sampler_bank& bank) {
+  if (batch.empty()) return;
+  int num_cells=num_cols*num_rows;
+  vector<uint64_t> lo(batch.size()), hi(batch.size());
+  for (int u=0; u<batch.size(); u++) hash_128(batch[u].first,seed,lo[u],hi[u]);
+  int cols[num_rows];
+  size_t written=0; // counters before this have had write-back started
   for (int i=0; i<num_samplers; i++) {
-    free_3d_long_array(phi_s[i],j,num_cols,num_rows);
-    free_3d_long_array(iota_s[i],j,num_cols,num_rows);
+    for (int u=0; u<batch.size(); u++) {
+      uint64_t h=sampler_unique_hash(lo[u],hi[u],ps_s[i]);
+      if (h>>63) continue; // not kept by level 0
+      sampler_cols(lo[u],hi[u],ps_s[i],num_rows,num_cols,cols);
+      for (int k=0; k<j; k++) {
+        if (h>>(63-k)) break; // level k keeps h<2^(63-k)
+        size_t level=bank_level(i,k,j,num_cells);
+        update_s_sparse(batch[u].first,batch[u].second,num_rows,cols,bank.phi+level,bank.iota+level);
+      }
+    }
+    size_t swept=bank_level(i+1,0,j,num_cells);
+    if (bank.fd!=-1 && ((swept-written)*sizeof(long)>=WRITEBACK_BYTES || i==num_samplers-1)) {
+      write_back(bank,written,swept);
+      written=swept;
+    }
   }
+  batch.clear();
+}
+
+// start (asynchronous) write-back of counters [start,end) of phi & iota, so pages reach the file in order & can be evicted clean
+void write_back(sampler_bank& bank, size_t start, size_t end) {
+  sync_file_range(bank.fd,start*sizeof(long),(end-start)*sizeof(long),SYNC_FILE_RANGE_WRITE);
+  sync_file_range(bank.fd,(bank.cells+start)*sizeof(long),(end-start)*sizeof(long),SYNC_FILE_RANGE_WRITE);
 }
 
 /*-------------------*
  * s-SPARSE RECOVERY *
  *-------------------*/
 
-// choose hash function for each row of s-sparse recovery
-hash_params* choose_hash_functions(int num_cols, int num_rows) {
-  hash_params* ps_s=new hash_params[num_rows];
-  for (int i=0; i<num_rows; i++) ps_s[i]=generate_hash(num_cols);
-  return ps_s;
-}
-
-// update 1-sparse counters of the s-sparse recovery
-void update_s_sparse(uint64_t endpoint, int edge_value, int num_rows, hash_params* ps_s, long** phi_s, long** iota_s) {
-  for (int r=0; r<num_rows; r++) { // decide which sampler in each row to update
-    int c=hash_function(endpoint,ps_s[r]); // col to update
-    update_1_sparse_counters(endpoint,edge_value,r,c,phi_s,iota_s);
-  }
+// update 1-sparse counters of the s-sparse recovery, counter of col c & row r is phi[c*num_rows+r], cols[r]=col of row r
+void update_s_sparse(uint64_t endpoint, int edge_value, int num_rows, int* cols, long* phi, long* iota) {
+  for (int r=0; r<num_rows; r++) update_1_sparse_counters(endpoint,edge_value,cols[r]*num_rows+r,phi,iota);
 }
 
 // recover neighbourhood from s-sparse recovery counters
-set<uint64_t> recover_neighbourhood(int num_cols, int num_rows, long** phi_s, long** iota_s) {
+set<uint64_t> recover_neighbourhood(int num_cols, int num_rows, long* phi, long* iota) {
   set<uint64_t> neighbourhood;
-  for (int c=0; c<num_cols; c++) {
-    for (int r=0; r<num_rows; r++) {
-      if (verify_1_sparse(phi_s[c][r],iota_s[c][r])) {
-        neighbourhood.insert(iota_s[c][r]);
-      }
-  }}
+  for (int i=0; i<num_cols*num_rows; i++) {
+    if (verify_1_sparse(phi[i],iota[i])) {
+      neighbourhood.insert(iota[i]);
+    }
+  }
   return neighbourhood;
 }
 
 // recover vertex from recovered neighbourhood
-uint64_t recover_id(set<uint64_t> neighbourhood, int sparsity, uint64_t* hash_map) {
+uint64_t recover_id(set<uint64_t> neighbourhood, int sparsity, uint64_t seed, sampler_hash ps) {
   if (neighbourhood.size()>sparsity || neighbourhood.size()==0) return -1; // s-sparse recovery failed
   else { // return vertex in neighbourhood with min hash value
-    uint64_t min_hash=INT_MAX, min_val=-1;
+    uint64_t min_hash=UINT64_MAX, min_val=-1, lo, hi;
     for (set<uint64_t>::iterator it=neighbourhood.begin(); it!=neighbourhood.end(); it++) {
-      uint64_t h_i=hash_map[*it];
+      hash_128(*it,seed,lo,hi);
+      uint64_t h_i=sampler_unique_hash(lo,hi,ps);
       if (h_i<min_hash) { // lowest yet
         min_hash=h_i;
         min_val=*it;
@@ -373,17 +474,63 @@ uint64_t recover_id(set<uint64_t> neighbourhood, int sparsity, uint64_t* hash_ma
   }
 }
 
+/*------*
+ * IBLT *
+ *------*/
+
+// IBLT_ROWS rows (each with its own hash) with enough cols for IBLT_CELLS*s cells in total
+void iblt_geometry(int s, int& num_cols, int& num_rows) {
+  num_rows=IBLT_ROWS;
+  num_cols=ceil(IBLT_CELLS*s/IBLT_ROWS);
+  if (num_cols<2) num_cols=2; // a single col puts every id in the same cells
+}
+
+// recover edge ids by peeling pure cells, removing each recovered id from its other cells
+// complete=true iff every cell is empty afterwards, the counters are copied so the IBLT is unchanged
+set<uint64_t> peel_iblt(int num_cols, int num_rows, uint64_t seed, sampler_hash ps, long* phi_s, long* iota_s, bool& complete) {
+  vector<long> phi(num_cols*num_rows), iota(num_cols*num_rows);
+  deque<int> pure; // indices of cells which may be pure
+  for (int c=0; c<num_cols; c++) {
+    for (int r=0; r<num_rows; r++) {
+      int i=c*num_rows+r;
+      phi[i]=phi_s[i]; iota[i]=iota_s[i];
+      if (phi[i]!=0) pure.push_back(i);
+  }}
+
+  set<uint64_t> ids;
+  int cols[num_rows]; uint64_t lo, hi;
+  while (!pure.empty()) {
+    int i=pure.front(); pure.pop_front();
+    if (!verify_1_sparse(phi[i],iota[i])) continue;
+    uint64_t id=iota[i];
+    hash_128(id,seed,lo,hi);
+    sampler_cols(lo,hi,ps,num_rows,num_cols,cols);
+    if (cols[i%num_rows]!=i/num_rows) continue; // id does not belong in this cell so cell is not pure
+
+    ids.insert(id);
+    for (int r=0; r<num_rows; r++) { // remove id from each of its cells
+      int k=cols[r]*num_rows+r;
+      phi[k]-=1; iota[k]-=id;
+      if (phi[k]!=0) pure.push_back(k);
+    }
+  }
+
+  complete=true;
+  for (int i=0; i<num_cols*num_rows && complete; i++) if (phi[i]!=0 || iota[i]!=0) complete=false;
+  return ids;
+}
+
 /*-------------------*
  * 1-SPARSE RECOVERY *
  *-------------------*/
 
 // update counters with new edge
-void update_1_sparse_counters(uint64_t index,int delta,int row,int col,long** phi_s,long** iota_s) {
+void update_1_sparse_counters(uint64_t index,int delta,int cell,long* phi,long* iota) {
   try {
-    //cout<<phi_s[col][row]<<","<<iota_s[col][row]<<","<<" ("<<delta<<","<<index<<") ";
-    phi_s[col][row] +=delta;
-    iota_s[col][row]+=delta*index;
-    //cout<<phi_s[col][row]<<","<<iota_s[col][row]<<endl;
+    //cout<<phi[cell]<<","<<iota[cell]<<","<<" ("<<delta<<","<<index<<") ";
+    phi[cell] +=delta;
+    iota[cell]+=delta*index;
+    //cout<<phi[cell]<<","<<iota[cell]<<endl;
   } catch (exception exp) {
     cout<<"***********************************VERIFY 1 SPARSE COUNTERS FAILURE";
   }
@@ -399,40 +546,44 @@ bool verify_1_sparse(int phi,int iota) {
  * HASHING *
  *---------*/
 
-// generate parameters to use in hash function
-hash_params generate_hash(int m) {
-  default_random_engine generator;
-  generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
-  uniform_int_distribution<unsigned long> distribution(0,P-1);
-  hash_params ps={
-    distribution(generator),
-    distribution(generator),
-    (unsigned long)m
-  };
+// splitmix64 finaliser
+inline uint64_t mix_64(uint64_t x) {
+  x+=0x9e3779b97f4a7c15ULL;
+  x=(x^(x>>30))*0xbf58476d1ce4e5b9ULL;
+  x=(x^(x>>27))*0x94d049bb133111ebULL;
+  return x^(x>>31);
+}
+
+// 128-bit hash of an edge id, computed once per update
+inline void hash_128(uint64_t x, uint64_t seed, uint64_t& lo, uint64_t& hi) {
+  lo=mix_64(seed^x);
+  hi=mix_64(lo^(seed<<32|seed>>32));
+}
+
+// random parameters for one sampler, multipliers are odd
+sampler_hash generate_sampler_hash(mt19937_64& generator) {
+  sampler_hash ps={generator()|1,generator()|1,generator(),generator()|1,generator()|1,generator()};
   return ps;
 }
 
-// hash a key
-int hash_function(int key, hash_params ps) {
-  return ((ps.a*key+ps.b)%P)%ps.m;
+// top 64 bits of a_lo*lo+a_hi*hi+b*2^64 (vector multiply-shift)
+uint64_t multiply_shift(uint64_t lo, uint64_t hi, uint64_t a_lo, uint64_t a_hi, uint64_t b) {
+  unsigned __int128 x=(unsigned __int128)a_lo*lo+(unsigned __int128)a_hi*hi+((unsigned __int128)b<<64);
+  return x>>64;
+}
+
+// unique hash of an edge id for a sampler, 64 bits so ties (which the unique hash maps avoided) are negligible
+uint64_t sampler_unique_hash(uint64_t lo, uint64_t hi, sampler_hash& ps) {
+  return multiply_shift(lo,hi,ps.a_lo,ps.a_hi,ps.a_b);
 }
 
-// generate random hash with unique values for all keys
-uint64_t* generate_random_hash(int n, uint64_t m) {
-  vector<uint64_t> used; // record hash values which have been used
-  uint64_t* hash_map=new uint64_t[n+1];
-  default_random_engine generator;
-  generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
-  uniform_int_distribution<uint64_t> distribution(0,m);
-  for (int i=1; i<=n; i++) {
-    // find unique hash_value
-    uint64_t hash_value=distribution(generator);
-    while (find(used.begin(), used.end(), hash_value)!=used.end()) hash_value=distribution(generator);
-
-    hash_map[i]=hash_value;         // store in hash map
-    used.push_back(hash_value); // record hash_value as used
+// col of each row for a sampler, taken from 16 bit fields of the col hash (remixed every 4 rows)
+inline void sampler_cols(uint64_t lo, uint64_t hi, sampler_hash& ps, int num_rows, int num_cols, int* cols) {
+  uint64_t g=multiply_shift(lo,hi,ps.c_lo,ps.c_hi,ps.c_b);
+  for (int r=0; r<num_rows; r+=4) {
+    if (r>0) g=mix_64(g);
+    for (int f=0; f<4 && r+f<num_rows; f++) cols[r+f]=((g>>(48-16*f)&0xFFFF)*num_cols)>>16;
   }
-  return hash_map;
 }
 
 
@@ -538,14 +689,6 @@ long*** initalise_zero_3d_array(int depth, int num_cols, int num_rows) {
   return arr;
 }
 
- // allocate space of 2d array of hash parameters
-hash_params** initalise_2d_hash_params_array(int num_cols, int num_rows) {
-  hash_params** arr = (hash_params**) malloc(num_cols * sizeof(hash_params*)); // allocate cols
-  // allocate rows
-  for (int i=0; i<num_cols; i++) arr[i]=(hash_params*) malloc(num_rows * sizeof(hash_params));
-  return arr;
-}
-
 // free space of 3d array of long integers
 void free_3d_long_array(long*** arr, int depth, int num_cols, int num_rows) {
   for (int d=0; d<depth; d++) {
@@ -558,14 +701,6 @@ void free_3d_long_array(long*** arr, int depth, int num_cols, int num_rows) {
   }
 }
 
-// free space of 2d array of hash parameters
-void free_2d_hash_params_array(hash_params** arr, int num_cols, int num_rows) {
-  for (int c=0; c<num_cols; c++) {
-    hash_params* ptr=arr[c];
-    free(ptr);
-  }
-}
-
 // return variance of values in a vector
 double variance(vector<uint64_t> vals) {
   if (vals.size()<=1) return 0;
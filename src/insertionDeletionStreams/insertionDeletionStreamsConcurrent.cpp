@@ -0,0 +1,245 @@
+/*
+ * One pass c-approximation Streaming Algorithm for Neighbourhood Detection for Insertion-Deletion Graph Streams (Using Vertex Sampling)
+ * The stream is read by several producer threads which update one shared sampler bank
+ */
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <mutex>
+#include <random>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "samplerBank.h"
+
+using namespace std;
+
+int P=1073741789; // >2^30
+int POOL_BLOCKS_PER_CHUNK=4; // number of sampler blocks worth of counters allocated by the pool at once
+bool USE_IBLT=false; // s-sparse recovery by peeling an IBLT of IBLT_CELLS*s cells in IBLT_ROWS rows
+int IBLT_ROWS=3;
+double IBLT_CELLS=1.3;
+bool HARVEST_LEVELS=false; // recover every decoded neighbour from every level of a sampler, not just the min hash one (fewer samplers, see expected_harvest)
+int BATCH_SIZE=65536; // block updates a producer buffers before summing them per sampler & flushing, 0 adds each update to the bank as it arrives
+int PREFETCH_DISTANCE=0; // samplers ahead whose counters are prefetched while the current sampler is updated, 0 disables
+int RESERVOIR_CAPACITY=0; // every block starts as a sketch, a reservoir would be replayed by whichever producer deletes first while others append to it
+bool HUGE_PAGES=false; // back pool chunks with huge pages (see insertionDeletionStreamsThreaded.cpp)
+int NUMA_PLACEMENT=0;
+size_t HUGE_PAGE_SIZE=2<<20;
+int PRODUCERS=4; // threads reading the stream, each reads a contiguous partition of the edge file
+
+/*------------*
+ * SIGNATURES *
+ *------------*/
+
+void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, string edge_file_path, string vertex_file_path, string out_file);
+void benchmark_producers(int c, int d, int n, string edge_file_path, string vertex_file_path, int max_producers, int reps, string out_file);
+
+// Main algorithm
+void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, set<vertex>& neighbourhood, vertex& root);
+
+ /*------*
+ * BODY *
+ *------*/
+
+int main() {
+
+  string edge_file_path, vertex_file_path, out_file;
+  int num_vertices, d, reps;
+
+  // details of graph to perform on
+  //edge_file_path="../../data/facebook_deletion.edges"; vertex_file_path=""; num_vertices=747; d=267; reps=2;
+  edge_file_path="../../data/gplus_deletion.edges"; vertex_file_path=""; num_vertices=12417; d=4998; reps=10; // sample vertices by hash, no .vertices file needed
+  out_file="gplus_concurrent_results.csv";
+  execute_test(5,20,1,reps,d,num_vertices,edge_file_path,vertex_file_path,out_file);
+
+  // time a pass with 1,2,4,..,8 producers
+  //benchmark_producers(10,d,num_vertices,edge_file_path,vertex_file_path,8,reps,"gplus_producers.csv");
+}
+
+void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, string edge_file_path, string vertex_file_path, string out_file) {
+  ofstream outfile(out_file);
+  outfile<<"name,"<<((vertex_file_path=="") ? edge_file_path : vertex_file_path)<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"repetitions,"<<reps<<endl<<"delta,0.2"<<endl<<"gamma,0.3"<<endl<<"vertex sample size,1.2*(num_vertices/c)"<<endl<<"L0 per vertex,ceil((1/success_rate)*log(1-.9)/log(1-((c-1)/(double)d)))"<<((HARVEST_LEVELS) ? " with (c-1)/d times expected_harvest" : "")<<endl<<"harvest levels,"<<HARVEST_LEVELS<<endl<<"iblt,"<<USE_IBLT<<endl<<"batch size,"<<BATCH_SIZE<<endl<<"producers,"<<PRODUCERS<<endl; // test details
+  outfile<<"c,time (microseconds), generating l0 hash time (microseconds) ,mean max space (bytes), l0 hash space (bytes), variance time, variance max space,successes"<<endl; // headers
+  set<vertex> neighbourhood; vertex root; // variables for returned values
+  vector<uint64_t> times, total_space, hash_times, hash_space; // results of each run of c
+  int successes;
+  //for (int c=c_min;c<=c_max;c+=c_step) {
+  for (int c=c_max;c>=c_min;c-=c_step) {
+    successes=0;
+    times.clear(); total_space.clear(); hash_times.clear(); hash_space.clear();
+    for (int i=0;i<reps;i++) {
+      cout<<"("<<i<<"/"<<reps<<") "<<c<<"/"<<c_max<<endl; // output to terminal
+
+      // reset values
+      BYTES=0; L0_HASH_BYTES=0; GENERATING_L0_HASH_TIME=0;
+      neighbourhood.clear(); vertex* p=&root; p=nullptr;
+
+      time_point before=chrono::high_resolution_clock::now(); // time before execution
+      single_pass_insertion_deletion_stream(c,d,n,edge_file_path,vertex_file_path,neighbourhood,root);
+      time_point after=chrono::high_resolution_clock::now(); // time after execution
+
+      cout<<root<<endl;
+      cout<<neighbourhood.size()<<"("<<d/c<<")"<<endl<<endl;
+
+      if (neighbourhood.size()!=0) successes+=1;
+
+      auto duration = chrono::duration_cast<chrono::microseconds>(after-before).count(); // time passed
+      cout<<"DURATION "<<duration/1000000<<"s"<<endl<<"SPACE "<<BYTES/pow(1024,2)<<"MBs"<<endl;
+      cout<<"HASH DURATION "<<GENERATING_L0_HASH_TIME/1000000<<"s"<<endl<<"HASH SPACE "<<L0_HASH_BYTES/pow(1024,2)<<"MBs"<<endl<<endl;
+      cout<<"STORING VALUES";
+      times.push_back(duration); total_space.push_back(BYTES);
+      cout<<" *";
+      hash_times.push_back(GENERATING_L0_HASH_TIME); hash_space.push_back(L0_HASH_BYTES);
+      cout<<"\rVALUES STORED               "<<endl;
+    }
+    cout<<"CALCULATING MEAN";
+    uint64_t mean_duration   =mean(times);
+    uint64_t mean_total_space=mean(total_space);
+    uint64_t mean_hash_space =mean(hash_space);
+    uint64_t mean_hash_time  =mean(hash_times);
+
+    double variance_duration   =variance(times);
+    double variance_total_space=variance(total_space);
+    double variance_hash_space =variance(hash_space);
+    double variance_hash_time  =variance(hash_times);
+    cout<<"\rCALCULATED VARAIANCE"<<endl<<endl;
+    outfile<<c<<","<<mean_duration<<","<<mean_hash_time<<","<<mean_total_space<<","<<mean_hash_space<<","<<variance_duration<<","<<variance_hash_time<<","<<variance_total_space<<","<<variance_hash_space<<","<<successes<<endl; // write values to file
+  }
+  outfile.close();
+}
+
+// mean time of a pass with PRODUCERS=1,2,4,..,max_producers
+void benchmark_producers(int c, int d, int n, string edge_file_path, string vertex_file_path, int max_producers, int reps, string out_file) {
+  int old_producers=PRODUCERS;
+  set<vertex> neighbourhood; vertex root;
+
+  ofstream outfile(out_file);
+  outfile<<"name,"<<edge_file_path<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"c,"<<c<<endl<<"repetitions,"<<reps<<endl<<"batch size,"<<BATCH_SIZE<<endl;
+  outfile<<"producers,time (microseconds),speedup,successes"<<endl; // headers
+  double single_time=0;
+  for (PRODUCERS=1; PRODUCERS<=max_producers; PRODUCERS*=2) {
+    vector<uint64_t> times; int successes=0;
+    for (int i=0; i<reps; i++) {
+      BYTES=0; L0_HASH_BYTES=0; GENERATING_L0_HASH_TIME=0;
+      neighbourhood.clear();
+      time_point before=chrono::high_resolution_clock::now();
+      single_pass_insertion_deletion_stream(c,d,n,edge_file_path,vertex_file_path,neighbourhood,root);
+      time_point after=chrono::high_resolution_clock::now();
+      times.push_back(chrono::duration_cast<chrono::microseconds>(after-before).count());
+      if (neighbourhood.size()!=0) successes+=1;
+    }
+    uint64_t mean_time=mean(times);
+    if (PRODUCERS==1) single_time=mean_time;
+    cout<<"PRODUCERS "<<PRODUCERS<<": "<<mean_time<<"us"<<endl;
+    outfile<<PRODUCERS<<","<<mean_time<<","<<single_time/mean_time<<","<<successes<<endl;
+  }
+  outfile.close();
+  PRODUCERS=old_producers;
+}
+
+/*----------------*
+ * MAIN ALGORITHM *
+ *----------------*/
+
+// if vertex_file_path=="" the vertex sample is decided by hash as each vertex first appears, so no vertex file (or pre-pass) is needed
+void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, set<vertex>& neighbourhood, vertex& root) {
+  // prepare samplers
+  sampler_bank bank;
+  choose_bank_parameters(bank,c,d,num_vertices);
+  vertex_sampling sampling=initialise_vertex_sampling(vertex_file_path,num_vertices,bank.vertex_sample_size);
+  // neighbours are hashed once per block update, level k keeps neighbours with unique hash < 2^(63-k), a 1/2^(k+1) fraction
+  initialise_sampler_bank(bank,mt19937_64(chrono::system_clock::now().time_since_epoch().count())());
+
+  // counters are only ever added to & sketches are linear, so producers add straight into the shared bank with relaxed atomics
+  // BATCH_SIZE=0: every cell update is an atomic add
+  // BATCH_SIZE>0: a producer buffers its updates, sums those of each sampler in a scratch sampler & flushes it with one atomic add per non zero cell
+  // bank_lock is held exclusively only to add a block (which may move the vectors of the bank), producers hold it shared to update
+  shared_mutex bank_lock;
+  ifstream size_stream(edge_file_path,ifstream::ate|ifstream::binary);
+  long file_size=size_stream.tellg();
+  atomic<int> edge_counter(0);
+  BYTES+=sizeof(shared_mutex)+sizeof(long)+sizeof(atomic<int>);
+  BYTES+=PRODUCERS*(sizeof(thread)+sizeof(map<vertex,int>)); // producer & known blocks
+
+  auto produce=[&](int producer) {
+    // lines which start in bytes [start,end) of the edge file
+    long start=file_size*producer/PRODUCERS, end=file_size*(producer+1)/PRODUCERS;
+    ifstream edge_stream(edge_file_path);
+    string line; edge e; vertex v; vertex target;
+    long position=start;
+    if (start>0) { // skip line which started in previous partition
+      edge_stream.seekg(start-1);
+      getline(edge_stream,line);
+      position=start+line.size();
+    }
+
+    update_buffer buffer;
+    initialise_update_buffer(buffer,bank,true);
+    map<vertex,int> known_blocks; // blocks are never moved or removed so once seen a block index can be used without the lock
+    uint64_t lo, hi; int lines_read=0;
+
+    while (position<end && getline(edge_stream,line)) {
+      position+=line.size()+1;
+      int edges_read=++edge_counter;
+      if (producer==0 && ++lines_read%1000==0) cout<<"\r"<<edges_read;
+
+      parse_edge(line,e);
+      if (e.value==0) continue; // malformed or blank line, endpoints are -1
+      vertex endpoints[2]={e.fst,e.snd};
+      for (int x=0; x<2; x++) { // update every l0 sampler of each sampled endpoint
+        target=endpoints[x]; v=endpoints[1-x]; // other endpoint is the neighbour
+        if (!is_sampled(sampling,target)) continue;
+        map<vertex,int>::iterator it=known_blocks.find(target);
+        if (it==known_blocks.end()) {
+          unique_lock<shared_mutex> exclusive(bank_lock);
+          map<vertex,int>::iterator block=bank.sample_blocks.find(target);
+          if (block==bank.sample_blocks.end()) block=add_sampler_block(bank,target); // first update of block in any producer
+          it=known_blocks.insert(*block).first;
+        }
+
+        hash_128(v,bank.seed,lo,hi); // shared by every sampler of the block
+        block_update up={it->second,v,e.value,lo,hi,vertex_fingerprint(bank,v)};
+        if (BATCH_SIZE==0) {
+          shared_lock<shared_mutex> shared(bank_lock);
+          update_block(bank,buffer,up);
+          continue;
+        }
+        buffer.batch.push_back(up);
+        if (buffer.batch.size()==BATCH_SIZE) {
+          shared_lock<shared_mutex> shared(bank_lock);
+          apply_update_batch(bank,buffer);
+        }
+      }
+    }
+    if (BATCH_SIZE>0) { // rest of partition
+      shared_lock<shared_mutex> shared(bank_lock);
+      apply_update_batch(bank,buffer);
+    }
+    free_update_buffer(buffer);
+  };
+
+  cout<<"STREAM STARTING"<<endl;
+  vector<thread> producers;
+  for (int producer=0; producer<PRODUCERS; producer++) producers.push_back(thread(produce,producer));
+  for (thread& producer : producers) producer.join(); // every update is visible to the recovery once all producers have joined
+  cout<<"\rDONE                                             "<<endl; // spaces to "clear" line
+  print_vertex_sample(bank);
+
+  // return first neighbourhood of size > d/c
+  if (!find_neighbourhood(bank,d/c,num_vertices,false,true,neighbourhood,root)) {
+    cout<<"\rFAILED to find neighbourhood";
+    neighbourhood.clear();
+    vertex* p=&root;
+    p=nullptr;
+  }
+
+  // free space
+  free_sampler_bank(bank);
+}
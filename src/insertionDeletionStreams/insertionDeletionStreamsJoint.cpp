@@ -0,0 +1,423 @@
+/*
+ * One pass c-approximation Streaming Algorithm for Neighbourhood Detection for Insertion-Deletion Graph Streams (Using Vertex Sampling)
+ * Sampled vertices share one sketch over composite keys (sampled vertex, neighbour) rather than a block of samplers each
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "samplerBank.h"
+
+using namespace std;
+
+int P=1073741789; // >2^30
+int POOL_BLOCKS_PER_CHUNK=4; // number of sampler blocks worth of counters allocated by the pool at once
+bool USE_IBLT=false; // s-sparse recovery by peeling an IBLT of IBLT_CELLS*s cells in IBLT_ROWS rows
+int IBLT_ROWS=3;
+double IBLT_CELLS=1.3;
+bool HARVEST_LEVELS=false; // recover every decoded neighbour from every level of a sampler, not just the min hash one (fewer samplers, see expected_harvest)
+int BATCH_SIZE=65536; // block updates collected before they are bucketed by block & applied, 0 applies each update as it arrives
+int PREFETCH_DISTANCE=0; // samplers ahead whose counters are prefetched while the current sampler is updated, 0 disables
+int RESERVOIR_CAPACITY=0; // every block of the per vertex layout starts as a sketch, so benchmark_layouts compares counters with counters
+bool HUGE_PAGES=false; // back pool chunks with huge pages (see insertionDeletionStreamsThreaded.cpp)
+int NUMA_PLACEMENT=0;
+size_t HUGE_PAGE_SIZE=2<<20;
+bool JOINT_SKETCH=true; // one sketch shared by every sampled vertex, so its capacity is split in proportion to their degrees, false gives each a block of samplers
+double JOINT_SPACE_FRACTION=1.0; // counters of the joint sketch as a fraction of those of a block for every vertex of the sample
+int JOINT_REPETITIONS=1; // independently hashed copies of the joint sketch
+
+/*-----------------*
+ * DATA STRUCTURES *
+ *-----------------*/
+
+using item = long; // composite key target*(num_vertices+1)+neighbour of the joint sketch
+
+
+struct joint_sketch { // IBLT per level over composite keys, level 0 keeps every key & level k>0 keys with hash<2^(64-k)
+  int repetitions, num_levels, num_cols, num_rows;
+  vector<sampler_hash> ps_s; // hash of each repetition
+  vector<long*> phi_s, iota_s; // counters of each repetition, cell (k,c,r) at (k*num_cols+c)*num_rows+r
+  vector<int> cols; // col of each row for the key being updated
+  counter_pool pool;
+};
+
+/*------------*
+ * SIGNATURES *
+ *------------*/
+
+void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, string edge_file_path, string vertex_file_path, string out_file);
+
+// Main algorithm
+void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, set<vertex>& neighbourhood, vertex& root);
+
+// Joint sketch
+void single_pass_joint_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, set<vertex>& neighbourhood, vertex& root);
+void initialise_joint_sketch(joint_sketch& sketch, size_t num_counters, int repetitions, double max_keys);
+void update_joint_sketch(joint_sketch& sketch, item key, int value, uint64_t lo, uint64_t hi);
+set<item> peel_joint_level(joint_sketch& sketch, int r, int k, uint64_t seed, bool& complete);
+bool decode_joint_sketch(joint_sketch& sketch, uint64_t seed, int threshold, int num_vertices, map<vertex,int>& degrees, set<vertex>& neighbourhood, vertex& root);
+void free_joint_sketch(joint_sketch& sketch);
+item joint_key(vertex target, vertex v, int num_vertices);
+void joint_cols(uint64_t lo, uint64_t hi, sampler_hash& ps, int num_rows, int num_cols, int* cols);
+void benchmark_layouts(int c_min, int c_max, int c_step, int reps, int d, int n, string edge_file_path, string vertex_file_path, vector<double> fractions, string out_file);
+
+ /*------*
+ * BODY *
+ *------*/
+
+int main() {
+
+  string edge_file_path, vertex_file_path, out_file;
+  int num_vertices, d, reps;
+
+  // details of graph to perform on
+  //edge_file_path="../../data/facebook_deletion.edges"; vertex_file_path=""; num_vertices=747; d=267; reps=2;
+  edge_file_path="../../data/gplus_deletion.edges"; vertex_file_path=""; num_vertices=12417; d=4998; reps=10; // sample vertices by hash, no .vertices file needed
+  out_file="gplus_joint_results.csv";
+  execute_test(5,20,1,reps,d,num_vertices,edge_file_path,vertex_file_path,out_file);
+
+  // space & successes of the joint sketch at 1/8 to 1 times the counters of the per vertex layout, against the per vertex layout
+  //benchmark_layouts(5,20,5,reps,d,num_vertices,edge_file_path,vertex_file_path,{0.125,0.25,0.5,1},"gplus_layout_benchmark.csv");
+}
+
+void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, string edge_file_path, string vertex_file_path, string out_file) {
+  ofstream outfile(out_file);
+  outfile<<"name,"<<((vertex_file_path=="") ? edge_file_path : vertex_file_path)<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"repetitions,"<<reps<<endl<<"delta,0.2"<<endl<<"gamma,0.3"<<endl<<"vertex sample size,1.2*(num_vertices/c)"<<endl<<"L0 per vertex,ceil((1/success_rate)*log(1-.9)/log(1-((c-1)/(double)d)))"<<((HARVEST_LEVELS) ? " with (c-1)/d times expected_harvest" : "")<<endl<<"harvest levels,"<<HARVEST_LEVELS<<endl<<"iblt,"<<USE_IBLT<<endl<<"batch size,"<<BATCH_SIZE<<endl<<"joint sketch,"<<JOINT_SKETCH<<endl<<"joint space fraction,"<<JOINT_SPACE_FRACTION<<endl<<"joint repetitions,"<<JOINT_REPETITIONS<<endl; // test details
+  outfile<<"c,time (microseconds), generating l0 hash time (microseconds) ,mean max space (bytes), l0 hash space (bytes), variance time, variance max space,successes"<<endl; // headers
+  set<vertex> neighbourhood; vertex root; // variables for returned values
+  vector<uint64_t> times, total_space, hash_times, hash_space; // results of each run of c
+  int successes;
+  //for (int c=c_min;c<=c_max;c+=c_step) {
+  for (int c=c_max;c>=c_min;c-=c_step) {
+    successes=0;
+    times.clear(); total_space.clear(); hash_times.clear(); hash_space.clear();
+    for (int i=0;i<reps;i++) {
+      cout<<"("<<i<<"/"<<reps<<") "<<c<<"/"<<c_max<<endl; // output to terminal
+
+      // reset values
+      BYTES=0; L0_HASH_BYTES=0; GENERATING_L0_HASH_TIME=0;
+      neighbourhood.clear(); vertex* p=&root; p=nullptr;
+
+      time_point before=chrono::high_resolution_clock::now(); // time before execution
+      if (JOINT_SKETCH) single_pass_joint_stream(c,d,n,edge_file_path,vertex_file_path,neighbourhood,root);
+      else single_pass_insertion_deletion_stream(c,d,n,edge_file_path,vertex_file_path,neighbourhood,root);
+      time_point after=chrono::high_resolution_clock::now(); // time after execution
+
+      cout<<root<<endl;
+      cout<<neighbourhood.size()<<"("<<d/c<<")"<<endl<<endl;
+
+      if (neighbourhood.size()!=0) successes+=1;
+
+      auto duration = chrono::duration_cast<chrono::microseconds>(after-before).count(); // time passed
+      cout<<"DURATION "<<duration/1000000<<"s"<<endl<<"SPACE "<<BYTES/pow(1024,2)<<"MBs"<<endl;
+      cout<<"HASH DURATION "<<GENERATING_L0_HASH_TIME/1000000<<"s"<<endl<<"HASH SPACE "<<L0_HASH_BYTES/pow(1024,2)<<"MBs"<<endl<<endl;
+      cout<<"STORING VALUES";
+      times.push_back(duration); total_space.push_back(BYTES);
+      cout<<" *";
+      hash_times.push_back(GENERATING_L0_HASH_TIME); hash_space.push_back(L0_HASH_BYTES);
+      cout<<"\rVALUES STORED               "<<endl;
+    }
+    cout<<"CALCULATING MEAN";
+    uint64_t mean_duration   =mean(times);
+    uint64_t mean_total_space=mean(total_space);
+    uint64_t mean_hash_space =mean(hash_space);
+    uint64_t mean_hash_time  =mean(hash_times);
+
+    double variance_duration   =variance(times);
+    double variance_total_space=variance(total_space);
+    double variance_hash_space =variance(hash_space);
+    double variance_hash_time  =variance(hash_times);
+    cout<<"\rCALCULATED VARAIANCE"<<endl<<endl;
+    outfile<<c<<","<<mean_duration<<","<<mean_hash_time<<","<<mean_total_space<<","<<mean_hash_space<<","<<variance_duration<<","<<variance_hash_time<<","<<variance_total_space<<","<<variance_hash_space<<","<<successes<<endl; // write values to file
+  }
+  outfile.close();
+}
+
+// mean time, space & successes of the per vertex layout & of the joint sketch given each fraction of the counters of the per vertex layout
+void benchmark_layouts(int c_min, int c_max, int c_step, int reps, int d, int n, string edge_file_path, string vertex_file_path, vector<double> fractions, string out_file) {
+  ofstream outfile(out_file);
+  outfile<<"name,"<<((vertex_file_path=="") ? edge_file_path : vertex_file_path)<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"repetitions,"<<reps<<endl<<"joint repetitions,"<<JOINT_REPETITIONS<<endl; // test details
+  outfile<<"c,layout,space fraction,mean time (microseconds),mean max space (bytes),successes"<<endl; // headers
+  bool joint=JOINT_SKETCH; double joint_fraction=JOINT_SPACE_FRACTION; // restored afterwards
+  vector<double> layouts={0}; // 0 is the per vertex layout
+  layouts.insert(layouts.end(),fractions.begin(),fractions.end());
+  set<vertex> neighbourhood; vertex root;
+  vector<uint64_t> times, total_space;
+  for (int c=c_max; c>=c_min; c-=c_step) {
+    for (double fraction : layouts) {
+      JOINT_SKETCH=(fraction>0); JOINT_SPACE_FRACTION=fraction;
+      times.clear(); total_space.clear();
+      int successes=0;
+      for (int i=0; i<reps; i++) {
+        cout<<"("<<i<<"/"<<reps<<") "<<c<<"/"<<c_max<<" "<<((JOINT_SKETCH) ? "joint" : "per vertex")<<endl; // output to terminal
+        BYTES=0; L0_HASH_BYTES=0; GENERATING_L0_HASH_TIME=0;
+        neighbourhood.clear();
+        time_point before=chrono::high_resolution_clock::now(); // time before execution
+        if (JOINT_SKETCH) single_pass_joint_stream(c,d,n,edge_file_path,vertex_file_path,neighbourhood,root);
+        else single_pass_insertion_deletion_stream(c,d,n,edge_file_path,vertex_file_path,neighbourhood,root);
+        time_point after=chrono::high_resolution_clock::now(); // time after execution
+        if (neighbourhood.size()!=0) successes+=1;
+        times.push_back(chrono::duration_cast<chrono::microseconds>(after-before).count()); total_space.push_back(BYTES);
+      }
+      outfile<<c<<","<<((JOINT_SKETCH) ? "joint" : "per vertex")<<","<<((JOINT_SKETCH) ? fraction : 1)<<","<<mean(times)<<","<<mean(total_space)<<","<<successes<<endl;
+    }
+  }
+  JOINT_SKETCH=joint; JOINT_SPACE_FRACTION=joint_fraction;
+  outfile.close();
+}
+
+/*----------------*
+ * MAIN ALGORITHM *
+ *----------------*/
+
+// if vertex_file_path=="" the vertex sample is decided by hash as each vertex first appears, so no vertex file (or pre-pass) is needed
+void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, set<vertex>& neighbourhood, vertex& root) {
+  // prepare samplers
+  sampler_bank bank;
+  choose_bank_parameters(bank,c,d,num_vertices);
+  vertex_sampling sampling=initialise_vertex_sampling(vertex_file_path,num_vertices,bank.vertex_sample_size);
+  // neighbours are hashed once per block update, level k keeps neighbours with unique hash < 2^(63-k), a 1/2^(k+1) fraction
+  initialise_sampler_bank(bank,mt19937_64(chrono::system_clock::now().time_since_epoch().count())());
+  update_buffer buffer;
+  initialise_update_buffer(buffer,bank,false);
+
+  ifstream edge_stream(edge_file_path);
+
+  cout<<"STREAM STARTING"<<endl;
+  string line; edge e;
+  int edge_counter=0;
+  BYTES+=sizeof(string)+sizeof(edge)+sizeof(int);
+  while (getline(edge_stream,line)) {
+    edge_counter+=1;
+    if (edge_counter%1000==0) cout<<"\r"<<edge_counter;
+
+    parse_edge(line,e);
+    if (e.value==0) continue; // malformed or blank line, endpoints are -1
+    ingest_update(bank,buffer,sampling,e.fst,e.snd,e.value); // update every l0 sampler of each sampled endpoint
+    ingest_update(bank,buffer,sampling,e.snd,e.fst,e.value);
+  }
+  apply_update_batch(bank,buffer); // rest of stream
+  cout<<"\rDONE                                             "<<endl; // spaces to "clear" line
+  print_vertex_sample(bank);
+
+  // return first neighbourhood of size > d/c
+  if (!find_neighbourhood(bank,d/c,num_vertices,false,true,neighbourhood,root)) {
+    cout<<"\rFAILED to find neighbourhood";
+    neighbourhood.clear();
+    vertex* p=&root;
+    p=nullptr;
+  }
+
+  // free space
+  free_sampler_bank(bank);
+  free_update_buffer(buffer);
+}
+
+/*--------------*
+ * JOINT SKETCH *
+ *--------------*/
+
+// every update of a sampled vertex goes to one sketch over composite keys (sampled vertex, neighbour) so a level holds a fraction of the
+// edges of every sampled vertex, decoded keys are grouped by sampled vertex & space is only spent on the degrees the sample actually has
+void single_pass_joint_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, set<vertex>& neighbourhood, vertex& root) {
+  // space of the per vertex layout with the same parameters, see single_pass_insertion_deletion_stream
+  sampler_bank layout;
+  choose_bank_parameters(layout,c,d,num_vertices);
+  size_t num_counters=JOINT_SPACE_FRACTION*layout.vertex_sample_size*layout.samplers_per_l0*2*layout.j*layout.num_cols*layout.num_rows;
+  BYTES+=sizeof(size_t);
+
+  // sampled degrees sum to at most vertex_sample_size*d
+  joint_sketch sketch;
+  initialise_joint_sketch(sketch,num_counters,JOINT_REPETITIONS,layout.vertex_sample_size*(double)d);
+  BYTES+=sizeof(joint_sketch);
+  cout<<"Joint sketch repetitions:"<<sketch.repetitions<<endl<<"# levels:"<<sketch.num_levels<<endl<<"# cols per level:"<<sketch.num_cols<<endl<<"# rows per level:"<<sketch.num_rows<<endl;
+
+  vertex_sampling sampling=initialise_vertex_sampling(vertex_file_path,num_vertices,layout.vertex_sample_size);
+
+  uint64_t seed=mt19937_64(chrono::system_clock::now().time_since_epoch().count())();
+  uint64_t lo, hi;
+  map<vertex,int> degrees; // net degree of each sampled vertex which has had an update, orders decoding
+  BYTES+=3*sizeof(uint64_t)+sizeof(map<vertex,int>);
+
+  ifstream edge_stream(edge_file_path);
+
+  cout<<"STREAM STARTING"<<endl;
+  string line; edge e; vertex v; vertex target; item key;
+  map<vertex,int>::iterator it; // degree of sampled vertex
+  int edge_counter=0;
+  BYTES+=sizeof(string)+sizeof(edge)+2*sizeof(vertex)+sizeof(item)+sizeof(int);
+  while (getline(edge_stream,line)) {
+    edge_counter+=1;
+    if (edge_counter%1000==0) cout<<"\r"<<edge_counter;
+
+    parse_edge(line,e);
+    if (e.value==0) continue; // malformed or blank line, endpoints are -1
+    vertex endpoints[2]={e.fst,e.snd};
+    for (int x=0; x<2; x++) { // update the joint sketch with each sampled endpoint
+      target=endpoints[x]; v=endpoints[1-x]; // other endpoint is the neighbour
+      it=degrees.find(target);
+      if (it==degrees.end()) {
+        if (!is_sampled(sampling,target)) continue; // not sampled
+        it=degrees.insert(make_pair(target,0)).first;
+        BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*);
+      }
+      it->second+=e.value;
+      key=joint_key(target,v,num_vertices);
+      hash_128(key,seed,lo,hi);
+      update_joint_sketch(sketch,key,e.value,lo,hi);
+    }
+  }
+  cout<<"\rDONE                                             "<<endl; // spaces to "clear" line
+  cout<<"Vertex sample={";
+  for (map<vertex,int>::iterator it=degrees.begin(); it!=degrees.end(); it++) cout<<it->first<<",";
+  cout<<"\b}"<<endl;
+
+  neighbourhood.clear();
+  if (!decode_joint_sketch(sketch,seed,d/c,num_vertices,degrees,neighbourhood,root)) {
+    cout<<"\rFAILED to find neighbourhood";
+    neighbourhood.clear();
+    vertex* p=&root;
+    p=nullptr;
+  }
+  free_joint_sketch(sketch);
+}
+
+// split num_counters between the levels of each repetition, adding levels until the deepest is expected to peel
+// (max_keys/2^(num_levels-1) keys within IBLT_CELLS cells per key), then allocate the counters
+void initialise_joint_sketch(joint_sketch& sketch, size_t num_counters, int repetitions, double max_keys) {
+  sketch.repetitions=repetitions;
+  sketch.num_rows=IBLT_ROWS;
+  for (sketch.num_levels=1; sketch.num_levels<64; sketch.num_levels++) {
+    size_t cells=num_counters/(2*(size_t)repetitions*sketch.num_levels); // cells per level
+    sketch.num_cols=max((size_t)2,cells/sketch.num_rows);
+    double capacity=sketch.num_cols*sketch.num_rows/IBLT_CELLS; // keys a level is expected to peel
+    if (max_keys/pow(2,sketch.num_levels-1)<=capacity) break;
+  }
+
+  sketch.cols.resize(sketch.num_rows);
+  size_t level_cells=(size_t)sketch.num_levels*sketch.num_cols*sketch.num_rows;
+  initialise_counter_pool(sketch.pool,2*level_cells);
+  static mt19937_64 generator(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+  for (int r=0; r<repetitions; r++) {
+    sketch.phi_s.push_back(pool_allocate(sketch.pool,level_cells));
+    sketch.iota_s.push_back(pool_allocate(sketch.pool,level_cells));
+    sketch.ps_s.push_back(generate_sampler_hash(generator));
+  }
+  BYTES+=sketch.num_rows*sizeof(int)+repetitions*(2*sizeof(long*)+sizeof(sampler_hash)); // counter values are accounted for by the pool
+  L0_HASH_BYTES+=repetitions*sizeof(sampler_hash);
+}
+
+// add value*key to a cell of each row of every level of each repetition which keeps the key
+void update_joint_sketch(joint_sketch& sketch, item key, int value, uint64_t lo, uint64_t hi) {
+  int* cols=sketch.cols.data();
+  size_t level_cells=(size_t)sketch.num_cols*sketch.num_rows;
+  for (int r=0; r<sketch.repetitions; r++) {
+    uint64_t h=sampler_unique_hash(lo,hi,sketch.ps_s[r]);
+    joint_cols(lo,hi,sketch.ps_s[r],sketch.num_rows,sketch.num_cols,cols);
+    long* phi_k=sketch.phi_s[r]; long* iota_k=sketch.iota_s[r];
+    for (int k=0; k<sketch.num_levels; k++, phi_k+=level_cells, iota_k+=level_cells) {
+      if (k>0 && h>>(64-k)) break; // level k keeps h<2^(64-k)
+      for (int row=0; row<sketch.num_rows; row++) {
+        phi_k[cols[row]*sketch.num_rows+row]+=value;
+        iota_k[cols[row]*sketch.num_rows+row]+=value*key;
+      }
+    }
+  }
+}
+
+// keys of level k of repetition r, peeled as in peel_iblt, complete=true iff every cell is empty afterwards
+set<item> peel_joint_level(joint_sketch& sketch, int r, int k, uint64_t seed, bool& complete) {
+  size_t level_cells=(size_t)sketch.num_cols*sketch.num_rows;
+  vector<long> phi(sketch.phi_s[r]+k*level_cells,sketch.phi_s[r]+(k+1)*level_cells);
+  vector<long> iota(sketch.iota_s[r]+k*level_cells,sketch.iota_s[r]+(k+1)*level_cells);
+  vector<int> cols(sketch.num_rows); uint64_t lo, hi;
+  deque<size_t> pure; // indices of cells which may be pure
+  for (size_t i=0; i<level_cells; i++) if (phi[i]!=0) pure.push_back(i);
+
+  set<item> keys;
+  while (!pure.empty()) {
+    size_t i=pure.front(); pure.pop_front();
+    if (phi[i]!=1) continue;
+    item key=iota[i];
+    hash_128(key,seed,lo,hi);
+    joint_cols(lo,hi,sketch.ps_s[r],sketch.num_rows,sketch.num_cols,cols.data());
+    if (cols[i%sketch.num_rows]!=i/sketch.num_rows) continue; // key does not belong in this cell so cell is not pure
+
+    keys.insert(key);
+    for (int row=0; row<sketch.num_rows; row++) { // remove key from each of its cells
+      size_t c=(size_t)cols[row]*sketch.num_rows+row;
+      phi[c]-=1; iota[c]-=key;
+      if (phi[c]!=0) pure.push_back(c);
+    }
+  }
+
+  complete=true;
+  for (size_t i=0; i<level_cells && complete; i++) if (phi[i]!=0 || iota[i]!=0) complete=false;
+  return keys;
+}
+
+// group the keys peeled from each level by sampled vertex, levels are nested so once a level peels completely the deeper levels
+// of its repetition add nothing, then return the sampled vertex of highest degree with >= threshold recovered neighbours
+bool decode_joint_sketch(joint_sketch& sketch, uint64_t seed, int threshold, int num_vertices, map<vertex,int>& degrees, set<vertex>& neighbourhood, vertex& root) {
+  map<vertex,set<vertex>> neighbourhoods;
+  bool complete;
+  int num_keys=0;
+  for (int r=0; r<sketch.repetitions; r++) {
+    for (int k=0; k<sketch.num_levels; k++) {
+      set<item> keys=peel_joint_level(sketch,r,k,seed,complete);
+      for (set<item>::iterator it=keys.begin(); it!=keys.end(); it++) {
+        vertex target=*it/(num_vertices+1), v=*it%(num_vertices+1);
+        if (v>=1 && degrees.count(target)) neighbourhoods[target].insert(v); // ignore keys which cannot be (sampled vertex, neighbour)
+      }
+      num_keys+=keys.size();
+      if (complete) break;
+    }
+  }
+  cout<<"Keys recovered:"<<num_keys<<endl;
+
+  // sampled vertices of degree < threshold cannot have threshold neighbours, the rest are tried in descending degree
+  vector<pair<int,vertex>> order;
+  for (map<vertex,int>::iterator it=degrees.begin(); it!=degrees.end(); it++) if (it->second>=threshold) order.push_back(make_pair(it->second,it->first));
+  stable_sort(order.begin(),order.end(),[](const pair<int,vertex>& x, const pair<int,vertex>& y) {return x.first>y.first;});
+  for (int b=0; b<order.size(); b++) {
+    set<vertex>& recovered=neighbourhoods[order[b].second];
+    cout<<"\r"<<order[b].second<<" ("<<recovered.size()<<"/"<<order[b].first<<")                                       "<<endl;
+    if (recovered.size()>=threshold) {
+      neighbourhood=recovered;
+      root=order[b].second;
+      cout<<endl<<"SUCCESSES ("<<neighbourhood.size()<<")"<<endl;
+      cout<<"NEIGHBOURHOOD for "<<root<<"={";
+      for (set<vertex>::iterator it=neighbourhood.begin(); it!=neighbourhood.end(); it++) cout<<*it<<",";
+      cout<<"\b}"<<endl;
+      return true;
+    }
+  }
+  return false;
+}
+
+void free_joint_sketch(joint_sketch& sketch) {
+  free_counter_pool(sketch.pool);
+  sketch.phi_s.clear(); sketch.iota_s.clear(); sketch.ps_s.clear();
+}
+
+// composite key of an edge of a sampled vertex, vertex ids are at most num_vertices
+item joint_key(vertex target, vertex v, int num_vertices) {
+  return (item)target*(num_vertices+1)+v;
+}
+
+// col of each row of the joint sketch, which can have more than the 2^16 cols sampler_cols resolves, so each row takes a whole 64 bit hash
+void joint_cols(uint64_t lo, uint64_t hi, sampler_hash& ps, int num_rows, int num_cols, int* cols) {
+  uint64_t g=multiply_shift(lo,hi,ps.c_lo,ps.c_hi,ps.c_b);
+  for (int r=0; r<num_rows; r++) {
+    if (r>0) g=mix_64(g);
+    cols[r]=((unsigned __int128)g*num_cols)>>64;
+  }
+}
@@ -0,0 +1,485 @@
+/*
+ * One pass c-approximation Streaming Algorithm for Neighbourhood Detection for Insertion-Deletion Graph Streams (Using Vertex Sampling)
+ * Snapshots of the sampler bank are queried mid-stream by a second thread while ingest continues
+ * Checkpoints of the bank are persisted & subtracted to find neighbourhoods gained between two points of the stream
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "samplerBank.h"
+
+using namespace std;
+
+int P=1073741789; // >2^30
+int POOL_BLOCKS_PER_CHUNK=4; // number of sampler blocks worth of counters allocated by the pool at once
+bool USE_IBLT=false; // s-sparse recovery by peeling an IBLT of IBLT_CELLS*s cells in IBLT_ROWS rows
+int IBLT_ROWS=3;
+double IBLT_CELLS=1.3;
+bool HARVEST_LEVELS=false; // recover every decoded neighbour from every level of a sampler, not just the min hash one (fewer samplers, see expected_harvest)
+int BATCH_SIZE=65536; // block updates collected before they are bucketed by block & applied, 0 applies each update as it arrives
+int PREFETCH_DISTANCE=0; // samplers ahead whose counters are prefetched while the current sampler is updated, 0 disables
+int RESERVOIR_CAPACITY=-1; // neighbours a block keeps in a reservoir before it becomes a sketch, -1 as many as fit in the space of its counters, 0 starts every block as a sketch
+bool HUGE_PAGES=false; // back pool chunks with huge pages (see insertionDeletionStreamsThreaded.cpp)
+int NUMA_PLACEMENT=0;
+size_t HUGE_PAGE_SIZE=2<<20;
+int SNAPSHOT_INTERVAL_MS=0; // ms of ingest between snapshots, which are queried while ingest continues, 0 only answers at the end of the stream
+uint64_t SNAPSHOTS; // snapshots taken in the last pass
+uint64_t SNAPSHOT_TIME; // microseconds ingest was paused to copy the bank into snapshots in the last pass
+int CHECKPOINT_EDGES=0; // edges between checkpoints, the bank after e edges is persisted to CHECKPOINT_PREFIX<e>.sketch, 0 disables
+string CHECKPOINT_PREFIX="checkpoint_";
+
+/*-----------------*
+ * DATA STRUCTURES *
+ *-----------------*/
+
+struct sketch_snapshot { // copy of the sampler bank after a prefix of the stream, samplers are added as the live bank gains them
+  int edges; // length of prefix
+  sampler_bank bank; // parameters of the live bank, counters from the snapshot's own pool
+};
+
+struct sketch_header { // parameters of a persisted sketch, sketches can only be subtracted if all but edges, num_blocks & num_reservoirs match
+  int edges; // length of prefix
+  int num_blocks, num_reservoirs;
+  int samplers_per_l0, s, j, num_cols, num_rows;
+  uint64_t seed, fingerprint_base;
+};
+
+struct snapshot_queue { // double buffered snapshots, ingest copies into the buffer the query thread is not decoding
+  sketch_snapshot buffers[2];
+  int published=-1; // buffer of newest snapshot
+  int reading=-1; // buffer being decoded
+  uint64_t sequence=0; // snapshots published
+  bool done=false; // stream finished
+  mutex lock;
+  condition_variable ready;
+};
+
+/*------------*
+ * SIGNATURES *
+ *------------*/
+
+void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, string edge_file_path, string vertex_file_path, string out_file);
+
+// Main algorithm
+void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, set<vertex>& neighbourhood, vertex& root);
+
+// Snapshots
+bool take_snapshot(snapshot_queue& queue, int edges, sampler_bank& bank);
+void copy_to_snapshot(sketch_snapshot& snapshot, int edges, sampler_bank& bank);
+void query_snapshots(snapshot_queue& queue, int threshold, int num_vertices);
+void free_snapshot(sketch_snapshot& snapshot);
+// Checkpoints
+bool save_sketch(string file_path, sketch_header header, sampler_bank& bank);
+bool load_sketch(string file_path, sketch_header& header, sketch_snapshot& sketch);
+bool subtract_sketch(sketch_snapshot& later, sketch_snapshot& earlier);
+bool interval_neighbourhood(string earlier_file_path, string later_file_path, int threshold, int num_vertices, set<vertex>& neighbourhood, vertex& root);
+
+ /*------*
+ * BODY *
+ *------*/
+
+int main() {
+
+  string edge_file_path, vertex_file_path, out_file;
+  int num_vertices, d, reps;
+
+  // details of graph to perform on
+  //edge_file_path="../../data/facebook_deletion.edges"; vertex_file_path=""; num_vertices=747; d=267; reps=2;
+  edge_file_path="../../data/gplus_deletion.edges"; vertex_file_path=""; num_vertices=12417; d=4998; reps=10; // sample vertices by hash, no .vertices file needed
+  SNAPSHOT_INTERVAL_MS=60000; // query the graph every minute while the stream is read
+  out_file="gplus_snapshot_results.csv";
+  execute_test(5,20,1,reps,d,num_vertices,edge_file_path,vertex_file_path,out_file);
+
+  // vertices which gained a neighbourhood of size >= d/c between edges 100000 & 200000 of a pass with CHECKPOINT_EDGES=100000
+  /*set<vertex> neighbourhood; vertex root;
+  interval_neighbourhood("checkpoint_100000.sketch","checkpoint_200000.sketch",d/10,num_vertices,neighbourhood,root);
+  */
+}
+
+void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, string edge_file_path, string vertex_file_path, string out_file) {
+  ofstream outfile(out_file);
+  outfile<<"name,"<<((vertex_file_path=="") ? edge_file_path : vertex_file_path)<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"repetitions,"<<reps<<endl<<"delta,0.2"<<endl<<"gamma,0.3"<<endl<<"vertex sample size,1.2*(num_vertices/c)"<<endl<<"L0 per vertex,ceil((1/success_rate)*log(1-.9)/log(1-((c-1)/(double)d)))"<<((HARVEST_LEVELS) ? " with (c-1)/d times expected_harvest" : "")<<endl<<"harvest levels,"<<HARVEST_LEVELS<<endl<<"iblt,"<<USE_IBLT<<endl<<"batch size,"<<BATCH_SIZE<<endl<<"snapshot interval (ms),"<<SNAPSHOT_INTERVAL_MS<<endl; // test details
+  outfile<<"c,time (microseconds), generating l0 hash time (microseconds) ,mean max space (bytes), l0 hash space (bytes), variance time, variance max space,successes,mean snapshots,mean snapshot time (microseconds)"<<endl; // headers
+  set<vertex> neighbourhood; vertex root; // variables for returned values
+  vector<uint64_t> times, total_space, hash_times, hash_space, snapshots, snapshot_times; // results of each run of c
+  int successes;
+  //for (int c=c_min;c<=c_max;c+=c_step) {
+  for (int c=c_max;c>=c_min;c-=c_step) {
+    successes=0;
+    times.clear(); total_space.clear(); hash_times.clear(); hash_space.clear(); snapshots.clear(); snapshot_times.clear();
+    for (int i=0;i<reps;i++) {
+      cout<<"("<<i<<"/"<<reps<<") "<<c<<"/"<<c_max<<endl; // output to terminal
+
+      // reset values
+      BYTES=0; L0_HASH_BYTES=0; GENERATING_L0_HASH_TIME=0; SNAPSHOTS=0; SNAPSHOT_TIME=0;
+      neighbourhood.clear(); vertex* p=&root; p=nullptr;
+
+      time_point before=chrono::high_resolution_clock::now(); // time before execution
+      single_pass_insertion_deletion_stream(c,d,n,edge_file_path,vertex_file_path,neighbourhood,root);
+      time_point after=chrono::high_resolution_clock::now(); // time after execution
+
+      cout<<root<<endl;
+      cout<<neighbourhood.size()<<"("<<d/c<<")"<<endl<<endl;
+
+      if (neighbourhood.size()!=0) successes+=1;
+
+      auto duration = chrono::duration_cast<chrono::microseconds>(after-before).count(); // time passed
+      cout<<"DURATION "<<duration/1000000<<"s"<<endl<<"SPACE "<<BYTES/pow(1024,2)<<"MBs"<<endl;
+      cout<<"HASH DURATION "<<GENERATING_L0_HASH_TIME/1000000<<"s"<<endl<<"HASH SPACE "<<L0_HASH_BYTES/pow(1024,2)<<"MBs"<<endl;
+      cout<<"SNAPSHOTS "<<SNAPSHOTS<<" ("<<SNAPSHOT_TIME<<"us)"<<endl<<endl;
+      cout<<"STORING VALUES";
+      times.push_back(duration); total_space.push_back(BYTES);
+      cout<<" *";
+      hash_times.push_back(GENERATING_L0_HASH_TIME); hash_space.push_back(L0_HASH_BYTES);
+      snapshots.push_back(SNAPSHOTS); snapshot_times.push_back(SNAPSHOT_TIME);
+      cout<<"\rVALUES STORED               "<<endl;
+    }
+    cout<<"CALCULATING MEAN";
+    uint64_t mean_duration   =mean(times);
+    uint64_t mean_total_space=mean(total_space);
+    uint64_t mean_hash_space =mean(hash_space);
+    uint64_t mean_hash_time  =mean(hash_times);
+
+    double variance_duration   =variance(times);
+    double variance_total_space=variance(total_space);
+    double variance_hash_space =variance(hash_space);
+    double variance_hash_time  =variance(hash_times);
+    cout<<"\rCALCULATED VARAIANCE"<<endl<<endl;
+    outfile<<c<<","<<mean_duration<<","<<mean_hash_time<<","<<mean_total_space<<","<<mean_hash_space<<","<<variance_duration<<","<<variance_hash_time<<","<<variance_total_space<<","<<variance_hash_space<<","<<successes<<","<<mean(snapshots)<<","<<mean(snapshot_times)<<endl; // write values to file
+  }
+  outfile.close();
+}
+
+/*----------------*
+ * MAIN ALGORITHM *
+ *----------------*/
+
+// if vertex_file_path=="" the vertex sample is decided by hash as each vertex first appears, so no vertex file (or pre-pass) is needed
+// sketches are linear so the bank summarises every prefix of the stream, every SNAPSHOT_INTERVAL_MS it is copied & decoded by a query thread
+void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, set<vertex>& neighbourhood, vertex& root) {
+  // prepare samplers
+  sampler_bank bank;
+  choose_bank_parameters(bank,c,d,num_vertices);
+  vertex_sampling sampling=initialise_vertex_sampling(vertex_file_path,num_vertices,bank.vertex_sample_size);
+  mt19937_64 generator(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+  if (CHECKPOINT_EDGES>0) bank.fingerprint_base=1+generator()%(FINGERPRINT_P-1); // checkpoints are subtracted, see interval_neighbourhood
+  // neighbours are hashed once per block update, level k keeps neighbours with unique hash < 2^(63-k), a 1/2^(k+1) fraction
+  initialise_sampler_bank(bank,generator());
+  update_buffer buffer;
+  initialise_update_buffer(buffer,bank,false);
+
+  // snapshots are taken into whichever buffer is not being decoded, so ingest never waits for a query
+  snapshot_queue queue;
+  for (sketch_snapshot& snapshot : queue.buffers) snapshot.bank=bank; // empty, with its own pool
+  thread query_thread;
+  if (SNAPSHOT_INTERVAL_MS>0) query_thread=thread([&]() {query_snapshots(queue,d/c,num_vertices);});
+  time_point last_snapshot=chrono::high_resolution_clock::now();
+  BYTES+=sizeof(snapshot_queue)+sizeof(thread)+sizeof(time_point);
+  sketch_header checkpoint_header={0,0,0,bank.samplers_per_l0,bank.s,bank.j,bank.num_cols,bank.num_rows,bank.seed,bank.fingerprint_base};
+  BYTES+=sizeof(sketch_header);
+
+  ifstream edge_stream(edge_file_path);
+
+  cout<<"STREAM STARTING"<<endl;
+  string line; edge e;
+  int edge_counter=0;
+  BYTES+=sizeof(string)+sizeof(edge)+sizeof(int);
+  while (getline(edge_stream,line)) {
+    edge_counter+=1;
+    if (edge_counter%1000==0) cout<<"\r"<<edge_counter;
+
+    parse_edge(line,e);
+    if (e.value!=0) { // malformed or blank lines (endpoints -1) are skipped but still counted, so checkpoints stay at multiples of CHECKPOINT_EDGES lines
+      ingest_update(bank,buffer,sampling,e.fst,e.snd,e.value); // update every l0 sampler of each sampled endpoint
+      ingest_update(bank,buffer,sampling,e.snd,e.fst,e.value);
+    }
+
+    if (SNAPSHOT_INTERVAL_MS>0 && edge_counter%1000==0 && chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now()-last_snapshot).count()>=SNAPSHOT_INTERVAL_MS) {
+      time_point before=chrono::high_resolution_clock::now();
+      apply_update_batch(bank,buffer); // snapshot is of exactly the first edge_counter edges
+      if (take_snapshot(queue,edge_counter,bank)) SNAPSHOTS+=1;
+      last_snapshot=chrono::high_resolution_clock::now();
+      SNAPSHOT_TIME+=chrono::duration_cast<chrono::microseconds>(last_snapshot-before).count();
+    }
+    if (CHECKPOINT_EDGES>0 && edge_counter%CHECKPOINT_EDGES==0) {
+      apply_update_batch(bank,buffer); // checkpoint is of exactly the first edge_counter edges
+      checkpoint_header.edges=edge_counter;
+      if (!save_sketch(CHECKPOINT_PREFIX+to_string(edge_counter)+".sketch",checkpoint_header,bank)) cout<<"\rFAILED to save checkpoint "<<edge_counter<<endl;
+    }
+  }
+  apply_update_batch(bank,buffer); // rest of stream
+  if (SNAPSHOT_INTERVAL_MS>0) { // let the query thread finish the last snapshot
+    {
+      lock_guard<mutex> guard(queue.lock);
+      queue.done=true;
+    }
+    queue.ready.notify_one();
+    query_thread.join();
+  }
+  cout<<"\rDONE                                             "<<endl; // spaces to "clear" line
+  print_vertex_sample(bank);
+
+  // return first neighbourhood of size > d/c
+  if (!find_neighbourhood(bank,d/c,num_vertices,false,true,neighbourhood,root)) {
+    cout<<"\rFAILED to find neighbourhood";
+    neighbourhood.clear();
+    vertex* p=&root;
+    p=nullptr;
+  }
+
+  // free space
+  free_sampler_bank(bank);
+  free_update_buffer(buffer);
+  for (sketch_snapshot& snapshot : queue.buffers) free_snapshot(snapshot);
+}
+
+/*-----------*
+ * SNAPSHOTS *
+ *-----------*/
+
+// copy the live bank into the buffer which is not being decoded & publish it, ingest is only paused for the copy
+// false if the query thread is still decoding that buffer (an older snapshot), the snapshot is skipped rather than waited for
+bool take_snapshot(snapshot_queue& queue, int edges, sampler_bank& bank) {
+  int b;
+  {
+    lock_guard<mutex> guard(queue.lock);
+    b=(queue.published==-1) ? 0 : 1-queue.published;
+    if (queue.reading==b) return false;
+  }
+  copy_to_snapshot(queue.buffers[b],edges,bank); // query thread only takes the published buffer
+  {
+    lock_guard<mutex> guard(queue.lock);
+    queue.published=b;
+    queue.sequence+=1;
+  }
+  queue.ready.notify_one();
+  return true;
+}
+
+// copy counters, block details & reservoirs into a snapshot, counters of a sampler are contiguous so each is one copy
+// the buffer keeps its counters between snapshots, only samplers added to the live bank since it was last used are allocated
+void copy_to_snapshot(sketch_snapshot& snapshot, int edges, sampler_bank& bank) {
+  sampler_bank& copy=snapshot.bank;
+  int j=bank.j, num_cols=bank.num_cols, num_rows=bank.num_rows;
+  size_t added=bank.phi_s.size()-copy.phi_s.size();
+  for (size_t i=copy.phi_s.size(); i<bank.phi_s.size(); i++) {
+    copy.phi_s.push_back(pool_zero_3d_array(copy.pool,j,num_cols,num_rows));
+    copy.iota_s.push_back(pool_zero_3d_array(copy.pool,j,num_cols,num_rows));
+    if (copy.fingerprint_base!=0) copy.tau_s.push_back(pool_zero_3d_array(copy.pool,j,num_cols,num_rows));
+  }
+  BYTES+=added*(((copy.fingerprint_base!=0) ? 3 : 2)*(sizeof(long***)+j*(sizeof(long**)+num_cols*sizeof(long*)))+sizeof(sampler_hash)+sizeof(int)); // counter values are accounted for by the pool
+
+  size_t cells=(size_t)j*num_cols*num_rows;
+  for (size_t i=0; i<bank.phi_s.size(); i++) {
+    memcpy(copy.phi_s[i][0][0],bank.phi_s[i][0][0],cells*sizeof(long));
+    memcpy(copy.iota_s[i][0][0],bank.iota_s[i][0][0],cells*sizeof(long));
+    if (copy.fingerprint_base!=0) memcpy(copy.tau_s[i][0][0],bank.tau_s[i][0][0],cells*sizeof(long));
+  }
+  size_t old_neighbours=0, neighbours=0; // in reservoirs
+  for (vector<vertex>& reservoir : copy.reservoirs) old_neighbours+=reservoir.size();
+  copy.sample_blocks=bank.sample_blocks;
+  copy.block_vertices=bank.block_vertices;
+  copy.ps_s=bank.ps_s;
+  copy.sparsity_estimates=bank.sparsity_estimates;
+  copy.reservoirs=bank.reservoirs;
+  copy.reservoir_vertices=bank.reservoir_vertices;
+  for (vector<vertex>& reservoir : copy.reservoirs) neighbours+=reservoir.size();
+  if (neighbours>old_neighbours) BYTES+=(neighbours-old_neighbours)*sizeof(vertex); // growth of reservoirs
+  snapshot.edges=edges;
+}
+
+// decode each snapshot once it is published, reporting the neighbourhood found in it, until the stream is done
+void query_snapshots(snapshot_queue& queue, int threshold, int num_vertices) {
+  uint64_t seen=0; // sequence of last snapshot decoded
+  while (true) {
+    int b;
+    {
+      unique_lock<mutex> guard(queue.lock);
+      queue.ready.wait(guard,[&]() {return queue.sequence>seen || queue.done;});
+      if (queue.sequence==seen) return; // done & every snapshot decoded
+      seen=queue.sequence;
+      b=queue.published;
+      queue.reading=b;
+    }
+
+    sketch_snapshot& snapshot=queue.buffers[b];
+    set<vertex> neighbourhood; vertex root;
+    time_point before=chrono::high_resolution_clock::now();
+    bool found=find_neighbourhood(snapshot.bank,threshold,num_vertices,false,false,neighbourhood,root);
+    time_point after=chrono::high_resolution_clock::now();
+    cout<<"\rQUERY after "<<snapshot.edges<<" edges: ";
+    if (found) {
+      cout<<"NEIGHBOURHOOD for "<<root<<"={";
+      for (set<vertex>::iterator it=neighbourhood.begin(); it!=neighbourhood.end(); it++) cout<<*it<<",";
+      cout<<"\b}";
+    } else cout<<"none";
+    cout<<" ("<<chrono::duration_cast<chrono::microseconds>(after-before).count()<<"us)"<<endl;
+
+    {
+      lock_guard<mutex> guard(queue.lock);
+      queue.reading=-1;
+    }
+  }
+}
+
+void free_snapshot(sketch_snapshot& snapshot) {
+  free_sampler_bank(snapshot.bank);
+}
+
+/*-------------*
+ * CHECKPOINTS *
+ *-------------*/
+
+// persist a bank (live or snapshot), blocks are written with their sampler hashes so a later checkpoint of the same pass can be subtracted
+// layout: header, block vertices, sampler hashes, sparsity estimates, phi, iota (& tau if fingerprinted) of each sampler, then vertex, size & neighbours of each reservoir
+// reservoirs which have become blocks are not written
+bool save_sketch(string file_path, sketch_header header, sampler_bank& bank) {
+  ofstream file(file_path,ios::binary);
+  if (!file) return false;
+  vector<int> live; // reservoirs which are still reservoirs
+  for (int r=0; r<bank.reservoirs.size(); r++) if (bank.sample_blocks[bank.reservoir_vertices[r]]<0) live.push_back(r);
+  header.num_blocks=bank.block_vertices.size();
+  header.num_reservoirs=live.size();
+  size_t cells=(size_t)header.j*header.num_cols*header.num_rows;
+  file.write((char*) &header,sizeof(sketch_header));
+  file.write((char*) bank.block_vertices.data(),bank.block_vertices.size()*sizeof(vertex));
+  file.write((char*) bank.ps_s.data(),bank.ps_s.size()*sizeof(sampler_hash));
+  file.write((char*) bank.sparsity_estimates.data(),bank.sparsity_estimates.size()*sizeof(int));
+  for (size_t i=0; i<bank.phi_s.size(); i++) {
+    file.write((char*) bank.phi_s[i][0][0],cells*sizeof(long));
+    file.write((char*) bank.iota_s[i][0][0],cells*sizeof(long));
+    if (header.fingerprint_base!=0) file.write((char*) bank.tau_s[i][0][0],cells*sizeof(long));
+  }
+  for (int r : live) {
+    int size=bank.reservoirs[r].size();
+    file.write((char*) &bank.reservoir_vertices[r],sizeof(vertex));
+    file.write((char*) &size,sizeof(int));
+    file.write((char*) bank.reservoirs[r].data(),size*sizeof(vertex));
+  }
+  return file.good();
+}
+
+// read a sketch written by save_sketch, counters are taken from the sketch's own pool (free with free_snapshot)
+bool load_sketch(string file_path, sketch_header& header, sketch_snapshot& sketch) {
+  ifstream file(file_path,ios::binary);
+  if (!file.read((char*) &header,sizeof(sketch_header))) return false;
+  sampler_bank& bank=sketch.bank;
+  bank.samplers_per_l0=header.samplers_per_l0; bank.s=header.s; bank.j=header.j; bank.num_cols=header.num_cols; bank.num_rows=header.num_rows;
+  bank.fingerprint_base=header.fingerprint_base;
+  initialise_sampler_bank(bank,header.seed);
+  int total_samplers=header.num_blocks*header.samplers_per_l0;
+  size_t cells=(size_t)header.j*header.num_cols*header.num_rows;
+  sketch.edges=header.edges;
+  bank.block_vertices.resize(header.num_blocks);
+  bank.ps_s.resize(total_samplers);
+  bank.sparsity_estimates.resize(total_samplers);
+  file.read((char*) bank.block_vertices.data(),header.num_blocks*sizeof(vertex));
+  file.read((char*) bank.ps_s.data(),total_samplers*sizeof(sampler_hash));
+  file.read((char*) bank.sparsity_estimates.data(),total_samplers*sizeof(int));
+  for (int b=0; b<header.num_blocks; b++) bank.sample_blocks[bank.block_vertices[b]]=b;
+
+  for (int i=0; i<total_samplers && file; i++) {
+    bank.phi_s.push_back(pool_zero_3d_array(bank.pool,header.j,header.num_cols,header.num_rows));
+    bank.iota_s.push_back(pool_zero_3d_array(bank.pool,header.j,header.num_cols,header.num_rows));
+    file.read((char*) bank.phi_s[i][0][0],cells*sizeof(long));
+    file.read((char*) bank.iota_s[i][0][0],cells*sizeof(long));
+    if (header.fingerprint_base==0) continue;
+    bank.tau_s.push_back(pool_zero_3d_array(bank.pool,header.j,header.num_cols,header.num_rows));
+    file.read((char*) bank.tau_s[i][0][0],cells*sizeof(long));
+  }
+  for (int r=0; r<header.num_reservoirs && file; r++) {
+    vertex v; int size=0;
+    file.read((char*) &v,sizeof(vertex));
+    file.read((char*) &size,sizeof(int));
+    if (!file || size<0) return false;
+    add_reservoir(bank,v);
+    vector<vertex>& reservoir=bank.reservoirs.back();
+    reservoir.resize(size);
+    file.read((char*) reservoir.data(),size*sizeof(vertex));
+  }
+  return (bool) file;
+}
+
+// later-=earlier, sketches are linear so this leaves the sketch of the updates between the two checkpoints
+// an earlier reservoir is a prefix of the later reservoir of its vertex (reservoirs only take insertions), or is replayed out of the later block
+// false if the earlier sketch is not of a prefix of the same pass, counters built with different hashes cannot be subtracted
+bool subtract_sketch(sketch_snapshot& later, sketch_snapshot& earlier) {
+  sampler_bank& bank=later.bank;
+  int samplers_per_l0=bank.samplers_per_l0;
+  size_t cells=(size_t)bank.j*bank.num_cols*bank.num_rows;
+  for (int b=0; b<earlier.bank.block_vertices.size(); b++) {
+    map<vertex,int>::iterator it=bank.sample_blocks.find(earlier.bank.block_vertices[b]);
+    if (it==bank.sample_blocks.end() || it->second<0) return false; // blocks never become reservoirs
+    for (int x=0; x<samplers_per_l0; x++) {
+      int i=it->second*samplers_per_l0+x, k=b*samplers_per_l0+x; // same sampler in later & earlier
+      if (memcmp(&bank.ps_s[i],&earlier.bank.ps_s[k],sizeof(sampler_hash))!=0) return false;
+      bank.sparsity_estimates[i]-=earlier.bank.sparsity_estimates[k]; // net change in degree
+      long* phi=bank.phi_s[i][0][0]; long* iota=bank.iota_s[i][0][0];
+      long* earlier_phi=earlier.bank.phi_s[k][0][0]; long* earlier_iota=earlier.bank.iota_s[k][0][0];
+      for (size_t c=0; c<cells; c++) {
+        phi[c]-=earlier_phi[c];
+        iota[c]-=earlier_iota[c];
+      }
+      if (bank.fingerprint_base==0) continue;
+      long* tau=bank.tau_s[i][0][0]; long* earlier_tau=earlier.bank.tau_s[k][0][0];
+      for (size_t c=0; c<cells; c++) tau[c]=fingerprint_add(tau[c],FINGERPRINT_P-earlier_tau[c]);
+    }
+  }
+
+  update_buffer buffer;
+  initialise_update_buffer(buffer,bank,false);
+  bool subtracted=true;
+  for (int r=0; r<earlier.bank.reservoirs.size() && subtracted; r++) {
+    vector<vertex>& reservoir=earlier.bank.reservoirs[r];
+    map<vertex,int>::iterator it=bank.sample_blocks.find(earlier.bank.reservoir_vertices[r]);
+    if (it==bank.sample_blocks.end()) subtracted=false;
+    else if (it->second<0) { // still a reservoir, drop the neighbours inserted before the earlier checkpoint
+      vector<vertex>& later_reservoir=bank.reservoirs[-it->second-1];
+      subtracted=later_reservoir.size()>=reservoir.size() && equal(reservoir.begin(),reservoir.end(),later_reservoir.begin());
+      if (subtracted) later_reservoir.erase(later_reservoir.begin(),later_reservoir.begin()+reservoir.size());
+    } else { // became a block after the earlier checkpoint, which replayed the reservoir into it
+      for (vertex v : reservoir) {
+        block_update up={it->second,v,-1,0,0,vertex_fingerprint(bank,v)};
+        hash_128(v,bank.seed,up.lo,up.hi);
+        update_block(bank,buffer,up);
+      }
+    }
+  }
+  free_update_buffer(buffer);
+  return subtracted;
+}
+
+// first vertex whose net gain in neighbours between two checkpoints of one pass is >= threshold, found by decoding the difference
+// of the checkpoints so neither a second pass nor the edges of the interval are needed
+bool interval_neighbourhood(string earlier_file_path, string later_file_path, int threshold, int num_vertices, set<vertex>& neighbourhood, vertex& root) {
+  sketch_header earlier_header, later_header;
+  sketch_snapshot earlier, later;
+  bool loaded=load_sketch(earlier_file_path,earlier_header,earlier) && load_sketch(later_file_path,later_header,later);
+  bool same_pass=loaded && earlier_header.seed==later_header.seed && earlier_header.samplers_per_l0==later_header.samplers_per_l0 && earlier_header.s==later_header.s
+    && earlier_header.j==later_header.j && earlier_header.num_cols==later_header.num_cols && earlier_header.num_rows==later_header.num_rows && earlier_header.edges<=later_header.edges
+    && earlier_header.fingerprint_base==later_header.fingerprint_base;
+
+  bool found=false;
+  neighbourhood.clear();
+  if (same_pass && subtract_sketch(later,earlier)) {
+    cout<<"INTERVAL "<<earlier_header.edges<<"-"<<later_header.edges<<endl;
+    found=find_neighbourhood(later.bank,threshold,num_vertices,true,true,neighbourhood,root);
+    if (!found) cout<<"\rFAILED to find neighbourhood"<<endl;
+  } else cout<<"FAILED to subtract "<<earlier_file_path<<" from "<<later_file_path<<endl;
+
+  free_snapshot(earlier);
+  free_snapshot(later);
+  return found;
+}
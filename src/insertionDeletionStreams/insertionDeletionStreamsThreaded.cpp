@@ -0,0 +1,316 @@
+/*
+ * One pass c-approximation Streaming Algorithm for Neighbourhood Detection for Insertion-Deletion Graph Streams (Using Vertex Sampling)
+ * The sampled vertices are partitioned between worker threads, each scans the whole stream & keeps only the blocks of its own vertices
+ */
+
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <linux/perf_event.h>
+#include <map>
+#include <math.h>
+#include <random>
+#include <set>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "samplerBank.h"
+
+using namespace std;
+
+int P=1073741789; // >2^30
+int POOL_BLOCKS_PER_CHUNK=4; // number of sampler blocks worth of counters allocated by the pool at once
+bool USE_IBLT=false; // s-sparse recovery by peeling an IBLT of IBLT_CELLS*s cells in IBLT_ROWS rows
+int IBLT_ROWS=3;
+double IBLT_CELLS=1.3;
+bool HARVEST_LEVELS=false; // recover every decoded neighbour from every level of a sampler, not just the min hash one (fewer samplers, see expected_harvest)
+int BATCH_SIZE=65536; // block updates collected before they are bucketed by block & applied, 0 applies each update as it arrives
+int PREFETCH_DISTANCE=0; // samplers ahead whose counters are prefetched while the current sampler is updated, 0 disables
+int RESERVOIR_CAPACITY=-1; // neighbours a block keeps in a reservoir before it becomes a sketch, -1 as many as fit in the space of its counters, 0 starts every block as a sketch
+bool HUGE_PAGES=true; // back counter pool chunks with 2MB pages, reserved (MAP_HUGETLB) pages if there are any else transparent huge pages
+int NUMA_PLACEMENT=0; // counter pool chunks are placed by 0: first touch, 1: interleaving over every node, 2: binding to the node of the owning worker
+size_t HUGE_PAGE_SIZE=2*1024*1024;
+double HUGE_PAGE_COVERAGE; // fraction of the counter pools backed by huge pages at the end of the last pass
+
+/*------------*
+ * SIGNATURES *
+ *------------*/
+
+void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, string edge_file_path, string vertex_file_path, int num_threads, string out_file);
+void benchmark_threads(int c, int d, int n, string edge_file_path, string vertex_file_path, int max_threads, int reps, string out_file);
+void benchmark_huge_pages(int c, int d, int n, string edge_file_path, string vertex_file_path, int num_threads, int reps, string out_file);
+int open_dtlb_miss_counter();
+
+// Main algorithm
+void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, int num_threads, set<vertex>& neighbourhood, vertex& root);
+int vertex_owner(vertex v, int num_threads);
+
+// Utility
+const char* parse_mapped_edge(const char* p, const char* end, edge& e);
+
+ /*------*
+ * BODY *
+ *------*/
+
+int main() {
+
+  string edge_file_path, vertex_file_path, out_file;
+  int num_vertices, d, reps, num_threads;
+
+  // details of graph to perform on
+  //edge_file_path="../../data/facebook_deletion.edges"; vertex_file_path=""; num_vertices=747; d=267; reps=2;
+  edge_file_path="../../data/gplus_deletion.edges"; vertex_file_path=""; num_vertices=12417; d=4998; reps=10; // sample vertices by hash, no .vertices file needed
+  num_threads=4;
+  out_file="gplus_threaded_results.csv";
+  execute_test(5,20,1,reps,d,num_vertices,edge_file_path,vertex_file_path,num_threads,out_file);
+
+  // time a pass with 1,2,4,..,8 threads
+  //benchmark_threads(10,d,num_vertices,edge_file_path,vertex_file_path,8,reps,"gplus_threads.csv");
+  // compare dTLB misses & time of a pass with & without huge pages
+  //benchmark_huge_pages(10,d,num_vertices,edge_file_path,vertex_file_path,num_threads,reps,"gplus_huge_pages.csv");
+}
+
+void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, string edge_file_path, string vertex_file_path, int num_threads, string out_file) {
+  ofstream outfile(out_file);
+  outfile<<"name,"<<((vertex_file_path=="") ? edge_file_path : vertex_file_path)<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"repetitions,"<<reps<<endl<<"delta,0.2"<<endl<<"gamma,0.3"<<endl<<"vertex sample size,1.2*(num_vertices/c)"<<endl<<"L0 per vertex,ceil((1/success_rate)*log(1-.9)/log(1-((c-1)/(double)d)))"<<((HARVEST_LEVELS) ? " with (c-1)/d times expected_harvest" : "")<<endl<<"harvest levels,"<<HARVEST_LEVELS<<endl<<"iblt,"<<USE_IBLT<<endl<<"batch size,"<<BATCH_SIZE<<endl<<"threads,"<<num_threads<<endl<<"huge pages,"<<HUGE_PAGES<<endl<<"numa placement,"<<NUMA_PLACEMENT<<endl; // test details
+  outfile<<"c,time (microseconds), generating l0 hash time (microseconds) ,mean max space (bytes), l0 hash space (bytes), variance time, variance max space,successes"<<endl; // headers
+  set<vertex> neighbourhood; vertex root; // variables for returned values
+  vector<uint64_t> times, total_space, hash_times, hash_space; // results of each run of c
+  int successes;
+  //for (int c=c_min;c<=c_max;c+=c_step) {
+  for (int c=c_max;c>=c_min;c-=c_step) {
+    successes=0;
+    times.clear(); total_space.clear(); hash_times.clear(); hash_space.clear();
+    for (int i=0;i<reps;i++) {
+      cout<<"("<<i<<"/"<<reps<<") "<<c<<"/"<<c_max<<endl; // output to terminal
+
+      // reset values
+      BYTES=0; L0_HASH_BYTES=0; GENERATING_L0_HASH_TIME=0;
+      neighbourhood.clear(); vertex* p=&root; p=nullptr;
+
+      time_point before=chrono::high_resolution_clock::now(); // time before execution
+      single_pass_insertion_deletion_stream(c,d,n,edge_file_path,vertex_file_path,num_threads,neighbourhood,root);
+      time_point after=chrono::high_resolution_clock::now(); // time after execution
+
+      cout<<root<<endl;
+      cout<<neighbourhood.size()<<"("<<d/c<<")"<<endl<<endl;
+
+      if (neighbourhood.size()!=0) successes+=1;
+
+      auto duration = chrono::duration_cast<chrono::microseconds>(after-before).count(); // time passed
+      cout<<"DURATION "<<duration/1000000<<"s"<<endl<<"SPACE "<<BYTES/pow(1024,2)<<"MBs"<<endl;
+      cout<<"HASH DURATION "<<GENERATING_L0_HASH_TIME/1000000<<"s"<<endl<<"HASH SPACE "<<L0_HASH_BYTES/pow(1024,2)<<"MBs"<<endl<<endl;
+      cout<<"STORING VALUES";
+      times.push_back(duration); total_space.push_back(BYTES);
+      cout<<" *";
+      hash_times.push_back(GENERATING_L0_HASH_TIME); hash_space.push_back(L0_HASH_BYTES);
+      cout<<"\rVALUES STORED               "<<endl;
+    }
+    cout<<"CALCULATING MEAN";
+    uint64_t mean_duration   =mean(times);
+    uint64_t mean_total_space=mean(total_space);
+    uint64_t mean_hash_space =mean(hash_space);
+    uint64_t mean_hash_time  =mean(hash_times);
+
+    double variance_duration   =variance(times);
+    double variance_total_space=variance(total_space);
+    double variance_hash_space =variance(hash_space);
+    double variance_hash_time  =variance(hash_times);
+    cout<<"\rCALCULATED VARAIANCE"<<endl<<endl;
+    outfile<<c<<","<<mean_duration<<","<<mean_hash_time<<","<<mean_total_space<<","<<mean_hash_space<<","<<variance_duration<<","<<variance_hash_time<<","<<variance_total_space<<","<<variance_hash_space<<","<<successes<<endl; // write values to file
+  }
+  outfile.close();
+}
+
+// mean time of a pass with 1,2,4,..,max_threads threads
+void benchmark_threads(int c, int d, int n, string edge_file_path, string vertex_file_path, int max_threads, int reps, string out_file) {
+  set<vertex> neighbourhood; vertex root;
+
+  ofstream outfile(out_file);
+  outfile<<"name,"<<edge_file_path<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"c,"<<c<<endl<<"repetitions,"<<reps<<endl<<"batch size,"<<BATCH_SIZE<<endl<<"hardware threads,"<<thread::hardware_concurrency()<<endl;
+  outfile<<"threads,time (microseconds),speedup,mean max space (bytes),successes"<<endl; // headers
+  double single_time=0;
+  for (int num_threads=1; num_threads<=max_threads; num_threads*=2) {
+    vector<uint64_t> times, total_space; int successes=0;
+    for (int i=0; i<reps; i++) {
+      BYTES=0; L0_HASH_BYTES=0; GENERATING_L0_HASH_TIME=0;
+      neighbourhood.clear();
+      time_point before=chrono::high_resolution_clock::now();
+      single_pass_insertion_deletion_stream(c,d,n,edge_file_path,vertex_file_path,num_threads,neighbourhood,root);
+      time_point after=chrono::high_resolution_clock::now();
+      times.push_back(chrono::duration_cast<chrono::microseconds>(after-before).count()); total_space.push_back(BYTES);
+      if (neighbourhood.size()!=0) successes+=1;
+    }
+    uint64_t mean_time=mean(times);
+    if (num_threads==1) single_time=mean_time;
+    cout<<"THREADS "<<num_threads<<": "<<mean_time<<"us"<<endl;
+    outfile<<num_threads<<","<<mean_time<<","<<single_time/mean_time<<","<<mean(total_space)<<","<<successes<<endl;
+  }
+  outfile.close();
+}
+
+// mean time, dTLB load misses & huge page coverage of a pass with HUGE_PAGES off & on (misses are -1 if perf events are unavailable)
+void benchmark_huge_pages(int c, int d, int n, string edge_file_path, string vertex_file_path, int num_threads, int reps, string out_file) {
+  bool old_huge_pages=HUGE_PAGES;
+  set<vertex> neighbourhood; vertex root;
+
+  ofstream outfile(out_file);
+  outfile<<"name,"<<edge_file_path<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"c,"<<c<<endl<<"repetitions,"<<reps<<endl<<"threads,"<<num_threads<<endl<<"numa placement,"<<NUMA_PLACEMENT<<endl;
+  outfile<<"huge pages,time (microseconds),dtlb load misses,huge page coverage,mean max space (bytes)"<<endl; // headers
+  for (int huge_pages=0; huge_pages<2; huge_pages++) {
+    HUGE_PAGES=huge_pages;
+    vector<uint64_t> times, misses, total_space; double coverage=0;
+    for (int i=0; i<reps; i++) {
+      BYTES=0; L0_HASH_BYTES=0; GENERATING_L0_HASH_TIME=0;
+      neighbourhood.clear();
+      int counter=open_dtlb_miss_counter(); // opened before the workers are started so they inherit it
+      if (counter!=-1) {ioctl(counter,PERF_EVENT_IOC_RESET,0); ioctl(counter,PERF_EVENT_IOC_ENABLE,0);}
+      time_point before=chrono::high_resolution_clock::now();
+      single_pass_insertion_deletion_stream(c,d,n,edge_file_path,vertex_file_path,num_threads,neighbourhood,root);
+      time_point after=chrono::high_resolution_clock::now();
+      uint64_t count=0;
+      if (counter!=-1) {
+        ioctl(counter,PERF_EVENT_IOC_DISABLE,0);
+        if (read(counter,&count,sizeof(count))!=sizeof(count)) count=0;
+        close(counter);
+        misses.push_back(count);
+      }
+      times.push_back(chrono::duration_cast<chrono::microseconds>(after-before).count()); total_space.push_back(BYTES);
+      coverage+=HUGE_PAGE_COVERAGE/reps;
+    }
+    double mean_misses=(misses.size()==times.size()) ? (double) mean(misses) : -1;
+    cout<<"HUGE PAGES "<<huge_pages<<": "<<mean(times)<<"us, "<<mean_misses<<" dTLB misses, "<<100*coverage<<"% coverage"<<endl;
+    outfile<<huge_pages<<","<<mean(times)<<","<<mean_misses<<","<<coverage<<","<<mean(total_space)<<endl;
+  }
+  outfile.close();
+  HUGE_PAGES=old_huge_pages;
+}
+
+// perf event counting the dTLB load misses of this thread & threads it starts, -1 if it cannot be opened
+int open_dtlb_miss_counter() {
+  perf_event_attr attr={};
+  attr.size=sizeof(attr);
+  attr.type=PERF_TYPE_HW_CACHE;
+  attr.config=PERF_COUNT_HW_CACHE_DTLB|(PERF_COUNT_HW_CACHE_OP_READ<<8)|(PERF_COUNT_HW_CACHE_RESULT_MISS<<16);
+  attr.disabled=1; attr.inherit=1; attr.exclude_kernel=1; attr.exclude_hv=1;
+  return syscall(SYS_perf_event_open,&attr,0,-1,-1,0);
+}
+
+/*----------------*
+ * MAIN ALGORITHM *
+ *----------------*/
+
+// if vertex_file_path=="" the vertex sample is decided by hash as each vertex first appears, so no vertex file (or pre-pass) is needed
+// each of num_threads workers scans the mapped edge file & applies only the updates of the sampled vertices it owns,
+// blocks are never shared so no counter is written by two workers & the blocks are joined only for recovery
+void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, int num_threads, set<vertex>& neighbourhood, vertex& root) {
+  // prepare samplers
+  sampler_bank bank;
+  choose_bank_parameters(bank,c,d,num_vertices);
+  vertex_sampling sampling=initialise_vertex_sampling(vertex_file_path,num_vertices,bank.vertex_sample_size);
+  // neighbours are hashed once per block update, level k keeps neighbours with unique hash < 2^(63-k), a 1/2^(k+1) fraction
+  initialise_sampler_bank(bank,mt19937_64(chrono::system_clock::now().time_since_epoch().count())());
+
+  // the edge file is mapped once & read by every worker, so the stream is in the page cache for all but the first
+  int fd=open(edge_file_path.c_str(),O_RDONLY);
+  struct stat file_stat;
+  size_t file_size=(fd!=-1 && fstat(fd,&file_stat)==0) ? file_stat.st_size : 0;
+  const char* stream=(file_size>0) ? (const char*) mmap(nullptr,file_size,PROT_READ,MAP_PRIVATE,fd,0) : nullptr;
+  if (stream==MAP_FAILED) {stream=nullptr; file_size=0;}
+  if (stream!=nullptr) madvise((void*)stream,file_size,MADV_SEQUENTIAL);
+  // each worker has an empty bank of the pass for the sampled vertices it owns, its pool is created & first touched by the worker
+  // so its counters are placed on the NUMA node the worker runs on (see NUMA_PLACEMENT)
+  vector<sampler_bank> workers(num_threads,bank);
+  BYTES+=sizeof(int)+sizeof(size_t)+sizeof(char*)+sizeof(vector<sampler_bank>)+num_threads*sizeof(sampler_bank);
+
+  cout<<"STREAM STARTING"<<endl;
+  auto worker=[&](int w) {
+    sampler_bank& owned=workers[w];
+    update_buffer buffer;
+    initialise_update_buffer(buffer,owned,false);
+
+    edge e;
+    int edge_counter=0;
+    BYTES+=sizeof(edge)+sizeof(int);
+    for (const char* p=stream; p<stream+file_size;) {
+      p=parse_mapped_edge(p,stream+file_size,e);
+      edge_counter+=1;
+      if (w==0 && edge_counter%1000==0) cout<<"\r"<<edge_counter;
+
+      if (e.value==0) continue; // malformed or blank line, endpoints are -1
+      // update every l0 sampler of each sampled endpoint owned by w
+      if (vertex_owner(e.fst,num_threads)==w) ingest_update(owned,buffer,sampling,e.fst,e.snd,e.value);
+      if (vertex_owner(e.snd,num_threads)==w) ingest_update(owned,buffer,sampling,e.snd,e.fst,e.value);
+    }
+    apply_update_batch(owned,buffer); // rest of stream
+    free_update_buffer(buffer);
+  };
+  vector<thread> threads;
+  for (int w=0; w<num_threads; w++) threads.push_back(thread(worker,w));
+  for (thread& t : threads) t.join();
+  if (stream!=nullptr) munmap((void*)stream,file_size);
+  if (fd!=-1) close(fd);
+  HUGE_PAGE_COVERAGE=huge_page_coverage(workers);
+  cout<<"\rHuge page coverage:"<<100*HUGE_PAGE_COVERAGE<<"%"<<endl;
+
+  // blocks of the workers are joined in worker order, the counters stay where the owning worker placed them
+  for (sampler_bank& owned : workers) append_sampler_bank(bank,owned);
+  cout<<"\rDONE                                             "<<endl; // spaces to "clear" line
+  print_vertex_sample(bank);
+
+  // return first neighbourhood of size > d/c
+  if (!find_neighbourhood(bank,d/c,num_vertices,false,true,neighbourhood,root)) {
+    cout<<"\rFAILED to find neighbourhood";
+    neighbourhood.clear();
+    vertex* p=&root;
+    p=nullptr;
+  }
+
+  // free space
+  free_sampler_bank(bank);
+  for (sampler_bank& owned : workers) free_counter_pool(owned.pool);
+}
+
+// worker which owns the block of v, decided by hash so high degree vertices are not clustered by id
+int vertex_owner(vertex v, int num_threads) {
+  return mix_64(v)%num_threads;
+}
+
+/*-----------*
+ * UTILITIES *
+ *-----------*/
+
+// parse edge from the mapped line starting at p, same formats as parse_edge, returns start of next line
+const char* parse_mapped_edge(const char* p, const char* end, edge& e) {
+  e.value=1;
+  if (p<end && (*p=='I' || *p=='D')) { // insertion deletion edge
+    if (*p=='D') e.value=-1;
+    p+=2;
+  }
+  int ids[2]={0,0}; bool parsed[2]={false,false};
+  for (int x=0; x<2; x++) {
+    while (p<end && *p==' ') p++; // seperator
+    for (; p<end && *p>='0' && *p<='9'; p++) {
+      ids[x]=10*ids[x]+(*p-'0');
+      parsed[x]=true;
+    }
+  }
+  while (p<end && *p!='\n') p++; // rest of line
+
+  if (parsed[0] && parsed[1]) {
+    e.fst=ids[0];
+    e.snd=ids[1];
+  } else {
+    e.fst=-1;
+    e.snd=-1;
+    e.value=0;
+  }
+  return p+1;
+}
@@ -2,7 +2,6 @@
  * One pass c-approximation Streaming Algorithm for Neighbourhood Detection for Insertion-Deletion Graph Streams (Using Vertex Sampling)
  */
 
-#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iostream>
@@ -12,32 +11,22 @@
 #include <set>
 #include <string>
 #include <vector>
+#include "samplerBank.h"
 
 using namespace std;
 
-uint64_t BYTES; // space used atm
-uint64_t L0_HASH_BYTES; // space used atm
-uint64_t GENERATING_L0_HASH_TIME; // space used atm
 int P=1073741789; // >2^30
-
-/*-----------------*
- * DATA STRUCTURES *
- *-----------------*/
-
-using vertex = int; // typemap vertex
-using time_point=chrono::high_resolution_clock::time_point;
-
-struct edge { // undirected edge
-  vertex fst;
-  vertex snd;
-  int value;
-};
-
-struct hash_params { // parameters for hash function
-  unsigned long a;
-  unsigned long b;
-  unsigned long m;
-};
+int POOL_BLOCKS_PER_CHUNK=4; // number of sampler blocks worth of counters allocated by the pool at once
+bool USE_IBLT=false; // s-sparse recovery by peeling an IBLT of IBLT_CELLS*s cells in IBLT_ROWS rows
+int IBLT_ROWS=3;
+double IBLT_CELLS=1.3;
+bool HARVEST_LEVELS=false; // recover every decoded neighbour from every level of a sampler, not just the min hash one (fewer samplers, see expected_harvest)
+int BATCH_SIZE=65536; // block updates collected before they are bucketed by block & applied, 0 applies each update as it arrives
+int PREFETCH_DISTANCE=0; // samplers ahead whose counters are prefetched while the current sampler is updated, 0 disables (see benchmark_prefetching)
+int RESERVOIR_CAPACITY=-1; // neighbours a block keeps in a reservoir before it becomes a sketch, -1 as many as fit in the space of its counters, 0 starts every block as a sketch
+bool HUGE_PAGES=false; // back pool chunks with huge pages (see insertionDeletionStreamsThreaded.cpp)
+int NUMA_PLACEMENT=0;
+size_t HUGE_PAGE_SIZE=2<<20;
 
 /*------------*
  * SIGNATURES *
@@ -47,38 +36,13 @@ void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, stri
 
 // Main algorithm
 void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, set<vertex>& neighbourhood, vertex& root);
-set<vertex> generate_vertex_sample(string file_path, int num_vertices, int sample_size);
-
-// L0 Stream
-void initialise_l0_sampler_counters(int num_samplers, int j, int num_cols, int num_rows, long****& phi_s, long****& iota_s);
-void free_l0_sampler_counters(int num_samplers, int j, int num_cols, int num_rows, long**** phi_s, long**** iota_s);
-
-// s-sparse
-hash_params* choose_hash_functions(int num_cols, int num_rows);
-void update_s_sparse(vertex endpoint, int edge_value, int num_rows, hash_params* ps_s, long** phi_s, long** iota_s);
-set<vertex> recover_neighbourhood(int num_cols, int num_rows, long** phi_s, long** iota_s);
-vertex recover_vertex(set<vertex> neighbourhood, int sparsity, uint64_t* hash_map);
-
-// 1-sparse
-bool verify_1_sparse(int phi,int iota);
-void update_1_sparse_counters(int index,int delta,int row,int col,long** phi_s,long** iota_s);
-
-// Hashing
-hash_params generate_hash(int m);
-int hash_function(int key, hash_params ps);
-// n = num keys, m=possible hash values, hash=map from key to hash value
-uint64_t* generate_random_hash(int n, uint64_t m);
-
-// Utility
-void parse_edge(string str, edge& e);
-void parse_vertex(string str, vertex& v);
-int identify_endpoint(edge e,vertex target);
-long*** initalise_zero_3d_array(int depth, int num_cols, int num_rows);
-hash_params** initalise_2d_hash_params_array(int num_cols, int num_rows);
-void free_3d_long_array(long*** arr, int depth, int num_cols, int num_rows);
-void free_2d_hash_params_array(hash_params** arr, int num_cols, int num_rows);
-double variance(vector<uint64_t> vals);
-uint64_t mean(vector<uint64_t> vals);
+
+// Benchmarks
+void benchmark_hashing(int num_samplers, int num_levels, int num_rows, int num_cols, int num_vertices, int num_updates, string out_file);
+void benchmark_batching(int num_blocks, int samplers_per_l0, int num_levels, int num_rows, int num_cols, int num_vertices, int num_updates, string out_file);
+void benchmark_prefetching(int num_blocks, int samplers_per_l0, int num_levels, int num_rows, int num_cols, int num_vertices, int num_updates, int max_distance, string out_file);
+vector<block_update> random_block_updates(int num_blocks, int num_vertices, int num_updates);
+double time_ingest(vector<block_update>& updates, bool batched, int num_blocks, int samplers_per_l0, int num_levels, int num_rows, int num_cols);
 
  /*------*
  * BODY *
@@ -96,9 +60,17 @@ int main() {
   // details of graph to perform on
   //edge_file_path="../../data/facebook_deletion.edges"; vertex_file_path="../../data/facebook_deletion.vertices";num_vertices=747; d=267; reps=2;
   edge_file_path="../../data/gplus.edges"; vertex_file_path="../../data/gplus.vertices";num_vertices=12417; d=5948; reps=10;
+  //edge_file_path="../../data/gplus.edges"; vertex_file_path=""; num_vertices=12417; d=5948; reps=10; // sample vertices by hash, no .vertices file needed
   out_file="gplus_insertion_with_idv_algorithm.csv";
   execute_test(5,20,1,reps,d,num_vertices,edge_file_path,vertex_file_path,out_file);
 
+  // compare cost of hashing an update with the 128-bit hash against unique hash maps & hash_function
+  //benchmark_hashing(100,13,2,10,12417,100000,"hashing_benchmark.csv");
+  // compare applying updates as they arrive against batches bucketed by block
+  //benchmark_batching(9,500,13,2,10,12417,1000000,"batching_benchmark.csv");
+  // compare prefetch distances for both ingest paths
+  //benchmark_prefetching(9,500,13,2,10,12417,1000000,16,"prefetching_benchmark.csv");
+
   /*set<vertex> neighbourhood; vertex root; // variables for returned values
   int c=10;
   single_pass_insertion_deletion_stream(c,d,num_vertices,edge_file_path,vertex_file_path,neighbourhood,root);
@@ -110,7 +82,7 @@ int main() {
 
 void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, string edge_file_path, string vertex_file_path, string out_file) {
   ofstream outfile(out_file);
-  outfile<<"name,"<<vertex_file_path<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"repetitions,"<<reps<<endl<<"delta,0.2"<<endl<<"gamma,0.3"<<endl<<"vertex sample size,1.2*(num_vertices/c)"<<endl<<"L0 per vertex,ceil((1/success_rate)*log(1-.9)/log(1-((c-1)/(double)d)))"<<endl; // test details
+  outfile<<"name,"<<((vertex_file_path=="") ? edge_file_path : vertex_file_path)<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"repetitions,"<<reps<<endl<<"delta,0.2"<<endl<<"gamma,0.3"<<endl<<"vertex sample size,1.2*(num_vertices/c)"<<endl<<"L0 per vertex,ceil((1/success_rate)*log(1-.9)/log(1-((c-1)/(double)d)))"<<((HARVEST_LEVELS) ? " with (c-1)/d times expected_harvest" : "")<<endl<<"harvest levels,"<<HARVEST_LEVELS<<endl<<"iblt,"<<USE_IBLT<<endl<<"batch size,"<<BATCH_SIZE<<endl<<"reservoir capacity,"<<RESERVOIR_CAPACITY<<endl<<"reservoir answers,"<<((RESERVOIR_CAPACITY!=0) ? "L0 samples of a temporary block replaying the reservoir" : "none")<<endl; // test details
   outfile<<"c,time (microseconds), generating l0 hash time (microseconds) ,mean max space (bytes), l0 hash space (bytes), variance time, variance max space,successes"<<endl; // headers
   set<vertex> neighbourhood; vertex root; // variables for returned values
   vector<uint64_t> times, total_space, hash_times, hash_space; // results of each run of c
@@ -160,449 +132,194 @@ void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, stri
   outfile.close();
 }
 
-/*----------------*
- * MAIN ALGORITHM *
- *----------------*/
-
-void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, set<vertex>& neighbourhood, vertex& root) {
-  // L0 sampling parameters
-  double delta=0.2, gamma=0.3; // success_rate ~= P(L0 sampler returning a vertex given delta & gamma)
-
-  // calculate model feature
-  int vertex_sample_size=log(num_vertices); // TODO play with
-  //int vertex_sample_size=(1>(d/pow(c,2))) ? sqrt(num_vertices) : sqrt(num_vertices)*(d/pow(c,2)); // TODO play with
-  //int vertex_sample_size=(log(num_vertices)>((log(num_vertices)*d)/pow(c,4))) ? log(num_vertices) : ((log(num_vertices)*d)/pow(c,4));
-  //int samplers_per_l0=(d/c)*log(num_vertices); // TODO play with these
-  double success_rate=0.85;
-  int samplers_per_l0=ceil((1/success_rate)*log(1-.9)/log(1-((c-1)/(double)d)));
-  int total_samplers=vertex_sample_size*samplers_per_l0;
-  BYTES+=sizeof(int)*4;
-
-  cout<<"Vertex sample size:"<<vertex_sample_size<<endl<<"Samplers per vertex:"<<samplers_per_l0<<endl<<"Total Samplers:"<<total_samplers<<endl;
-  cout<<"d/c="<<d/c<<endl;
-
-  // generate vertex_sample
-  set<vertex> vertex_sample=generate_vertex_sample(vertex_file_path,num_vertices,vertex_sample_size);
-  cout<<"Vertex sample={";
-  for (set<vertex>::iterator it=vertex_sample.begin(); it!=vertex_sample.end(); it++) cout<<*it<<",";
-  cout<<"\b}"<<endl;
-
-  // prepare samplers
-  // sampler parameters
-  int s=1/delta; // sparsity to recover at
-  int j=log2(num_vertices); // number of s-sparse recoveries to run
-  int num_cols=2*s;
-  int num_rows=log(s/gamma);
-  BYTES+=sizeof(int)*4;
-  cout<<"Sparsity of s-sparse:"<<s<<endl<<"# s-sparse per L0:"<<j<<endl<<"# cols per s-sparse:"<<num_cols<<endl<<"# rows per s-sparse:"<<num_rows<<endl;
-
-  // allocate space for counters
-  long**** phi_s; long**** iota_s;
-  cout<<"ALLOCATING COUNTERS"<<endl;
-  initialise_l0_sampler_counters(total_samplers,j,num_cols,num_rows,phi_s,iota_s);
-  cout<<"\rDONE                                             "<<endl; // spaces to "clear" line
-  BYTES+=2*(sizeof(long****)+total_samplers*(sizeof(long***)+j*(sizeof(long**)+num_cols*(sizeof(long*)+num_rows*sizeof(long)))));
-
-  // generate unique_hash_map for each sampler
-  cout<<"GENERATING UNIQUE HASH MAPS"<<endl;
-  time_point before=chrono::high_resolution_clock::now(); // time before execution
-  uint64_t** unique_hash_maps=(uint64_t**) malloc(total_samplers * sizeof(uint64_t*));
+// time the hashing of num_updates updates to a block of num_samplers samplers
+// old: unique hash map lookup then hash_function for each row of each level which keeps the neighbour
+// new: one 128-bit hash per update, expanded to the unique hash & cols of each sampler by multiply-shift
+void benchmark_hashing(int num_samplers, int num_levels, int num_rows, int num_cols, int num_vertices, int num_updates, string out_file) {
+  mt19937_64 generator(chrono::system_clock::now().time_since_epoch().count());
+  uniform_int_distribution<int> distribution(1,num_vertices);
+  vector<vertex> updates(num_updates);
+  for (int u=0; u<num_updates; u++) updates[u]=distribution(generator);
+  uint64_t checksum=0; // stops hashes being optimised away
+
+  // old hashes
   uint64_t n3=pow(num_vertices,3);
-  for (int i=0; i<total_samplers; i++) {
-    if (i%10==0) cout<<"\r"<<i<<"/"<<total_samplers;
-    uint64_t* hash_map=generate_random_hash(num_vertices,n3);
-    unique_hash_maps[i]=hash_map;
-  }
-  BYTES+=sizeof(uint64_t**)+total_samplers*(sizeof(uint64_t*)+num_vertices*sizeof(uint64_t));
-  BYTES+=sizeof(uint64_t);
-  L0_HASH_BYTES+=sizeof(uint64_t**)+total_samplers*(sizeof(uint64_t*)+num_vertices*sizeof(uint64_t));
-  time_point after=chrono::high_resolution_clock::now(); // time before execution
-  GENERATING_L0_HASH_TIME=chrono::duration_cast<chrono::microseconds>(after-before).count();
-  cout<<"\rDONE                                             "<<endl; // spaces to "clear" line
-
-  // generate hashs for s-sparse recovery
-  hash_params*** ps_s=(hash_params***) malloc(total_samplers*sizeof(hash_params**));
-  for (int i=0; i<total_samplers; i++) {
-    ps_s[i]=initalise_2d_hash_params_array(j,num_rows); // each col is for one s-sparse recovery
-    for (int k=0; k<j; k++) ps_s[i][k]=choose_hash_functions(num_cols,num_rows);
-  }
-  BYTES+=sizeof(hash_params***)+total_samplers*(sizeof(hash_params**)+j*(sizeof(hash_params*)+num_rows*sizeof(hash_params)));
-
-  // hash limits for each value of j
-  uint64_t* hash_lims=new uint64_t[j];
-  for (int i=1; i<=j; i++) hash_lims[i]=n3/pow(2,i);
-  BYTES+=sizeof(uint64_t*)+j*sizeof(uint64_t);
-
-  int* sparsity_estimates=new int[total_samplers];
-  for (int i=0;i<total_samplers;i++) sparsity_estimates[i]=0;
-  BYTES+=sizeof(int*)+total_samplers*sizeof(int);
-
-  ifstream edge_stream(edge_file_path);
-
-  cout<<"STREAM STARTING"<<endl;
-  string line; edge e; vertex v; vertex target;
-  set<vertex>::iterator it; // track which vertex from sample is target for given sampler
-  int edge_counter=0;
-  BYTES+=sizeof(string)+sizeof(edge)+2*sizeof(vertex)+sizeof(int);
-  while (getline(edge_stream,line)) {
-    edge_counter+=1;
-    if (edge_counter%1000==0) cout<<"\r"<<edge_counter;
-
-    parse_edge(line,e);
-    it=vertex_sample.begin(); // whole sample for edge
-    target=*it;
-    for (int i=0; i<total_samplers; i++) { // update every l0 sampler
-      // check if target should be changed
-      if (i>0 && i%samplers_per_l0==0) it++; target=*it;
-      v=identify_endpoint(e,target); // determine if edge is connected to target, if so what is the other endpoint
-
-      if (v!=-1) { // edge is connected to current target
-        sparsity_estimates[i]+=e.value;
-        uint64_t h=unique_hash_maps[i][v]; // update certain s-sparse recoveries
-        for (int k=0; k<j; k++) if (h<=hash_lims[k]) update_s_sparse(v,e.value,num_rows,ps_s[i][k],phi_s[i][k],iota_s[i][k]);
-      }
-    }
-
+  uint64_t* hash_lims=new uint64_t[num_levels];
+  for (int k=0; k<num_levels; k++) hash_lims[k]=n3/pow(2,k+1);
+  vector<uint64_t*> unique_hash_maps; vector<hash_params**> ps_s;
+  for (int i=0; i<num_samplers; i++) {
+    unique_hash_maps.push_back(generate_random_hash(num_vertices,n3));
+    hash_params** ps=initalise_2d_hash_params_array(num_levels,num_rows);
+    for (int k=0; k<num_levels; k++) ps[k]=choose_hash_functions(num_cols,num_rows);
+    ps_s.push_back(ps);
   }
-  cout<<"\rDONE                                             "<<endl; // spaces to "clear" line
 
-  // recover neighbourhood for each
-  // return first neighbourhood of size > d/c
-  set<vertex> sampled_neighbourhood;
-  it=vertex_sample.begin(); // track which vertex from sample is target for given sampler
-  target=*it;
-  cout<<target<<endl;
-  for (int i=0; i<total_samplers; i++) {
-    if (i>0 && i%samplers_per_l0==0) {it++; target=*it; cout<<"\r"<<target<<"                                       "<<endl; neighbourhood.clear();} // restart neighbourhood since have run through all L0 samplers which were associated to a single sampled vertex
-    if (sparsity_estimates[i]>=2) {
-
-      int j_sample=log2(sparsity_estimates[i])-1; // -1 since 0 indexed
-      cout<<"\r"<<j_sample<<" "<<i<<"/"<<total_samplers<<"                                     ";
-      sampled_neighbourhood=recover_neighbourhood(num_cols,num_rows,phi_s[i][j_sample],iota_s[i][j_sample]);
-      vertex sampled_vertex=recover_vertex(sampled_neighbourhood,s,unique_hash_maps[i]);
-      if (sampled_vertex!=-1) {
-        neighbourhood.insert(sampled_vertex);
-        if (neighbourhood.size()>=(int)d/c) {
-          root=target;
-
-          cout<<endl<<"SUCCESSES ("<<neighbourhood.size()<<")"<<endl;
-          cout<<"NEIGHBOURHOOD for "<<target<<"={";
-          for (set<vertex>::iterator it=neighbourhood.begin(); it!=neighbourhood.end(); it++) cout<<*it<<",";
-          cout<<"\b}"<<endl;
-
-          // free space
-          free_l0_sampler_counters(total_samplers,j,num_cols,num_rows,phi_s,iota_s);
-          for (int i=0; i<total_samplers; i++) free_2d_hash_params_array(ps_s[i],j,num_rows);
-          free(ps_s);
-
-          return;
-        }
+  time_point before=chrono::high_resolution_clock::now();
+  for (int u=0; u<num_updates; u++) {
+    vertex v=updates[u];
+    for (int i=0; i<num_samplers; i++) {
+      uint64_t h=unique_hash_maps[i][v];
+      for (int k=0; k<num_levels && h<=hash_lims[k]; k++) {
+        for (int r=0; r<num_rows; r++) checksum+=hash_function(v,ps_s[i][k][r]);
       }
-
-    }
-
-    if (i==total_samplers-1) {
-      cout<<"\rFAILED to find neighbourhood";
-      neighbourhood.clear();
-      vertex* p=&root;
-      p=nullptr;
-      return;
     }
   }
-
-  cout<<"HERE"<<endl;
-
-}
-
-// Generate sample of vertices
-set<vertex> generate_vertex_sample(string file_path, int num_vertices, int sample_size) {
-  // chose indices of vertices
-  set<vertex> indices;
-  default_random_engine generator;
-  generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
-  uniform_int_distribution<int> distribution(0,num_vertices-1);
-  while (indices.size()<sample_size) { // set only contains unique items
-    int i=distribution(generator); // generate new value
-    indices.insert(i);
-  }
-
-  // run through stream pic out indices
-  ifstream vertex_stream(file_path);
-  set<vertex> sample;
-  string line; vertex v; int counter=0;
-  set<vertex>::iterator it=indices.begin();
-
-  while (getline(vertex_stream,line)) {
-    if (*it==counter) { // sample vertex
-      parse_vertex(line,v);
-      sample.insert(v);
-      it++;
-      if (it==indices.end()) break;
+  time_point after=chrono::high_resolution_clock::now();
+  double old_time=chrono::duration_cast<chrono::nanoseconds>(after-before).count()/(double)num_updates;
+
+  // new hashes
+  uint64_t seed=generator();
+  vector<sampler_hash> sampler_hashes;
+  for (int i=0; i<num_samplers; i++) sampler_hashes.push_back(generate_sampler_hash(generator));
+  int* cols=new int[num_rows]; uint64_t lo, hi;
+
+  before=chrono::high_resolution_clock::now();
+  for (int u=0; u<num_updates; u++) {
+    hash_128(updates[u],seed,lo,hi);
+    for (int i=0; i<num_samplers; i++) {
+      uint64_t h=sampler_unique_hash(lo,hi,sampler_hashes[i]);
+      sampler_cols(lo,hi,sampler_hashes[i],num_rows,num_cols,cols);
+      checksum+=h>>60;
+      for (int r=0; r<num_rows; r++) checksum+=cols[r];
     }
-    counter++; // increment line count
   }
+  after=chrono::high_resolution_clock::now();
+  double new_time=chrono::duration_cast<chrono::nanoseconds>(after-before).count()/(double)num_updates;
 
-  return sample;
-}
-
-
-/*-----------*
- * L0 Stream *
- *-----------*/
-
-// allocates space for the counters used for 1-sparse recovery
-// long**** = [sampler][s-sparse][s-sparse col][s-sparse row]
-void initialise_l0_sampler_counters(int num_samplers, int j, int num_cols, int num_rows, long****& phi_s, long****& iota_s) {
-  // prepare pointers
-  phi_s =(long****) malloc(num_samplers*sizeof(long***));
-  iota_s=(long****) malloc(num_samplers*sizeof(long***));
-
-  for (int i=0; i<num_samplers; i++) {
-    if (i%100==0) cout<<"\r"<<i;
-    try{
-      phi_s[i] =initalise_zero_3d_array(j,num_cols,num_rows); // sum of weights (sum ai)
-      iota_s[i]=initalise_zero_3d_array(j,num_cols,num_rows); // weighted sum of weights (sum ai*i)
-    } catch (const exception &e) { cout<<"1,"<<e.what()<<endl; }
-  }
-}
+  cout<<"OLD "<<old_time<<"ns/update"<<endl<<"NEW "<<new_time<<"ns/update"<<endl<<"("<<checksum%2<<")"<<endl;
+  ofstream outfile(out_file);
+  outfile<<"samplers,"<<num_samplers<<endl<<"levels,"<<num_levels<<endl<<"rows,"<<num_rows<<endl<<"cols,"<<num_cols<<endl<<"n,"<<num_vertices<<endl<<"updates,"<<num_updates<<endl;
+  outfile<<"hashing,time per update (nanoseconds),hash space (bytes)"<<endl; // headers
+  outfile<<"unique hash maps & hash_function,"<<old_time<<","<<num_samplers*((num_vertices+1)*sizeof(uint64_t)+num_levels*num_rows*sizeof(hash_params))<<endl;
+  outfile<<"128-bit hash & multiply-shift,"<<new_time<<","<<num_samplers*sizeof(sampler_hash)<<endl;
+  outfile<<"speedup,"<<old_time/new_time<<endl;
+  outfile.close();
 
-// free space used for counters
-void free_l0_sampler_counters(int num_samplers, int j, int num_cols, int num_rows, long**** phi_s, long**** iota_s) {
   for (int i=0; i<num_samplers; i++) {
-    free_3d_long_array(phi_s[i],j,num_cols,num_rows);
-    free_3d_long_array(iota_s[i],j,num_cols,num_rows);
+    delete[] unique_hash_maps[i];
+    for (int k=0; k<num_levels; k++) delete[] ps_s[i][k];
+    free(ps_s[i]);
   }
+  delete[] hash_lims; delete[] cols;
 }
 
-/*-------------------*
- * s-SPARSE RECOVERY *
- *-------------------*/
-
-// choose hash function for each row of s-sparse recovery
-hash_params* choose_hash_functions(int num_cols, int num_rows) {
-  hash_params* ps_s=new hash_params[num_rows];
-  for (int i=0; i<num_rows; i++) ps_s[i]=generate_hash(num_cols);
-  return ps_s;
-}
-
-// update 1-sparse counters of the s-sparse recovery
-void update_s_sparse(vertex endpoint, int edge_value, int num_rows, hash_params* ps_s, long** phi_s, long** iota_s) {
-  for (int r=0; r<num_rows; r++) { // decide which sampler in each row to update
-    int c=hash_function(endpoint,ps_s[r]); // col to update
-    update_1_sparse_counters(endpoint,edge_value,r,c,phi_s,iota_s);
-  }
-}
+// time num_updates random updates to num_blocks blocks, applied as they arrive & in batches of BATCH_SIZE bucketed by block
+void benchmark_batching(int num_blocks, int samplers_per_l0, int num_levels, int num_rows, int num_cols, int num_vertices, int num_updates, string out_file) {
+  vector<block_update> updates=random_block_updates(num_blocks,num_vertices,num_updates);
+  double times[2]; // ns per update, as they arrive & batched
+  for (int batched=0; batched<2; batched++) times[batched]=time_ingest(updates,batched,num_blocks,samplers_per_l0,num_levels,num_rows,num_cols);
 
-// recover neighbourhood from s-sparse recovery counters
-set<vertex> recover_neighbourhood(int num_cols, int num_rows, long** phi_s, long** iota_s) {
-  set<vertex> neighbourhood;
-  for (int c=0; c<num_cols; c++) {
-    for (int r=0; r<num_rows; r++) {
-      if (verify_1_sparse(phi_s[c][r],iota_s[c][r])) {
-        neighbourhood.insert(iota_s[c][r]);
-      }
-  }}
-  return neighbourhood;
+  cout<<"AS THEY ARRIVE "<<times[0]<<"ns/update"<<endl<<"BATCHED "<<times[1]<<"ns/update"<<endl;
+  ofstream outfile(out_file);
+  outfile<<"blocks,"<<num_blocks<<endl<<"samplers per block,"<<samplers_per_l0<<endl<<"levels,"<<num_levels<<endl<<"rows,"<<num_rows<<endl<<"cols,"<<num_cols<<endl<<"n,"<<num_vertices<<endl<<"updates,"<<num_updates<<endl<<"batch size,"<<BATCH_SIZE<<endl<<"prefetch distance,"<<PREFETCH_DISTANCE<<endl;
+  outfile<<"ingest,time per update (nanoseconds)"<<endl; // headers
+  outfile<<"as they arrive,"<<times[0]<<endl;
+  outfile<<"batched by block,"<<times[1]<<endl;
+  outfile<<"speedup,"<<times[0]/times[1]<<endl;
+  outfile.close();
 }
 
-// recover vertex from recovered neighbourhood
-vertex recover_vertex(set<vertex> neighbourhood, int sparsity, uint64_t* hash_map) {
-  if (neighbourhood.size()>sparsity || neighbourhood.size()==0) return -1; // s-sparse recovery failed
-  else { // return vertex in neighbourhood with min hash value
-    uint64_t min_hash=INT_MAX, min_val=-1;
-    for (set<vertex>::iterator it=neighbourhood.begin(); it!=neighbourhood.end(); it++) {
-      uint64_t h_i=hash_map[*it];
-      if (h_i<min_hash) { // lowest yet
-        min_hash=h_i;
-        min_val=*it;
-      }
-    }
-    return min_val;
-  }
-}
+// time both ingest paths with PREFETCH_DISTANCE=0,1,2,4,..,max_distance
+void benchmark_prefetching(int num_blocks, int samplers_per_l0, int num_levels, int num_rows, int num_cols, int num_vertices, int num_updates, int max_distance, string out_file) {
+  vector<block_update> updates=random_block_updates(num_blocks,num_vertices,num_updates);
+  int old_distance=PREFETCH_DISTANCE;
 
-/*-------------------*
- * 1-SPARSE RECOVERY *
- *-------------------*/
-
-// update counters with new edge
-void update_1_sparse_counters(int index,int delta,int row,int col,long** phi_s,long** iota_s) {
-  try {
-    phi_s[col][row] +=delta;
-    iota_s[col][row]+=delta*index;
-  } catch (exception exp) {
-    cout<<"***********************************VERIFY 1 SPARSE COUNTERS FAILURE";
+  ofstream outfile(out_file);
+  outfile<<"blocks,"<<num_blocks<<endl<<"samplers per block,"<<samplers_per_l0<<endl<<"levels,"<<num_levels<<endl<<"rows,"<<num_rows<<endl<<"cols,"<<num_cols<<endl<<"n,"<<num_vertices<<endl<<"updates,"<<num_updates<<endl<<"batch size,"<<BATCH_SIZE<<endl;
+  outfile<<"prefetch distance,as they arrive (nanoseconds per update),batched by block (nanoseconds per update)"<<endl; // headers
+  for (int distance=0; distance<=max_distance; distance=(distance==0) ? 1 : 2*distance) {
+    PREFETCH_DISTANCE=distance;
+    double arrive_time=time_ingest(updates,false,num_blocks,samplers_per_l0,num_levels,num_rows,num_cols);
+    double batched_time=time_ingest(updates,true,num_blocks,samplers_per_l0,num_levels,num_rows,num_cols);
+    cout<<"DISTANCE "<<distance<<": AS THEY ARRIVE "<<arrive_time<<"ns/update, BATCHED "<<batched_time<<"ns/update"<<endl;
+    outfile<<distance<<","<<arrive_time<<","<<batched_time<<endl;
   }
+  outfile.close();
+  PREFETCH_DISTANCE=old_distance;
 }
 
-// verify if array is 1_sparse
-bool verify_1_sparse(int phi,int iota) {
-  if (phi==1) return true;
-  return false;
-}
-
-/*---------*
- * HASHING *
- *---------*/
-
-// generate parameters to use in hash function
-hash_params generate_hash(int m) {
-  default_random_engine generator;
-  generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
-  uniform_int_distribution<unsigned long> distribution(0,P-1);
-  hash_params ps={
-    distribution(generator),
-    distribution(generator),
-    (unsigned long)m
-  };
-  return ps;
-}
-
-// hash a key
-int hash_function(int key, hash_params ps) {
-  return ((ps.a*key+ps.b)%P)%ps.m;
-}
-
-// generate random hash with unique values for all keys
-uint64_t* generate_random_hash(int n, uint64_t m) {
-  vector<uint64_t> used; // record hash values which have been used
-  uint64_t* hash_map=new uint64_t[n+1];
-  default_random_engine generator;
-  generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
-  uniform_int_distribution<uint64_t> distribution(0,m);
-  for (int i=1; i<=n; i++) {
-    // find unique hash_value
-    uint64_t hash_value=distribution(generator);
-    while (find(used.begin(), used.end(), hash_value)!=used.end()) hash_value=distribution(generator);
-
-    hash_map[i]=hash_value;         // store in hash map
-    used.push_back(hash_value); // record hash_value as used
+// num_updates insertions of random neighbours to random blocks, already hashed
+vector<block_update> random_block_updates(int num_blocks, int num_vertices, int num_updates) {
+  mt19937_64 generator(chrono::system_clock::now().time_since_epoch().count());
+  uniform_int_distribution<int> vertex_distribution(1,num_vertices), block_distribution(0,num_blocks-1);
+  uint64_t seed=generator();
+  vector<block_update> updates(num_updates);
+  for (int u=0; u<num_updates; u++) {
+    updates[u].block=block_distribution(generator); updates[u].v=vertex_distribution(generator); updates[u].value=1;
+    hash_128(updates[u].v,seed,updates[u].lo,updates[u].hi);
   }
-  return hash_map;
+  return updates;
 }
 
-
-/*-----------*
- * UTILITIES *
- *-----------*/
-
-// parse edge from string "v1 v2" or "(I/D) v1 v2"
-void parse_edge(string str, edge& e) {
-  int spaces=count(str.begin(),str.end(),' ');
-
-  if (spaces==2) { // insertion deletion edge
-    if (str[0]=='D') e.value=-1;
-    else e.value=1;
-    str=str.substr(2,str.size());
-  } else if (spaces==1) { // insertion edge
-    e.value=1;
-  }
-
-  string fst="",snd="";
-  bool after=false;
-
-  for (char& c:str) {
-    if (c==' ') { // seperator
-      after=true;
-    } else if (after) { // second id
-      snd+=c;
-    } else { // first id
-      fst+=c;
+// ns per update to apply updates to fresh blocks, as they arrive or batched
+double time_ingest(vector<block_update>& updates, bool batched, int num_blocks, int samplers_per_l0, int num_levels, int num_rows, int num_cols) {
+  sampler_bank bank;
+  bank.samplers_per_l0=samplers_per_l0; bank.j=num_levels; bank.num_cols=num_cols; bank.num_rows=num_rows; bank.s=num_cols/2;
+  initialise_sampler_bank(bank,0);
+  for (int b=0; b<num_blocks; b++) add_sampler_block(bank,b);
+  update_buffer buffer;
+  initialise_update_buffer(buffer,bank,false);
+
+  time_point before=chrono::high_resolution_clock::now();
+  for (size_t u=0; u<updates.size(); u++) {
+    if (!batched) {
+      update_block(bank,buffer,updates[u]);
+      continue;
     }
+    buffer.batch.push_back(updates[u]);
+    if (buffer.batch.size()==BATCH_SIZE) apply_update_batch(bank,buffer);
   }
+  apply_update_batch(bank,buffer);
+  time_point after=chrono::high_resolution_clock::now();
 
-  // Update edge values
-  try {
-    e.fst=stoi(fst);
-    e.snd=stoi(snd);
-  } catch (exception ex) {
-    e.fst=-1;
-    e.snd=-1;
-    e.value=0;
-  }
-}
-
-// parse vertex from line in file
-void parse_vertex(string str, vertex& v) {
-  string vertex_name="";
-  for (char& c:str) {
-    if (c==',') break; // name done
-    vertex_name+=c;
-  }
-  v=stoi(vertex_name);
+  free_sampler_bank(bank);
+  free_update_buffer(buffer);
+  return chrono::duration_cast<chrono::nanoseconds>(after-before).count()/(double)updates.size();
 }
 
-// returns endpoint which is not target (or -1 if target not on edge)
-int identify_endpoint(edge e,vertex target) {
-  if (e.fst==target) return e.snd;
-  else if (e.snd==target) return e.fst;
-  else return -1;
-}
-
-// allocate space of 3d array of long intergers, all values set of 0
-long*** initalise_zero_3d_array(int depth, int num_cols, int num_rows) {
-  long*** arr;
-  try { arr = (long***) malloc(depth * sizeof(long**)); // allocate depth
-  } catch (const exception &e) { cout<<"2,"<<e.what()<<endl; }
-  for (int i=0; i<depth; i++) {
-    try { arr[i] = (long**) malloc(num_cols * sizeof(long*)); // allocate cols
-    } catch (const exception &e) { cout<<"3,"<<e.what()<<endl; }
-
-    for (int j=0; j<num_cols; j++) {
-      try { arr[i][j]=(long*) malloc(num_rows * sizeof(long)); // allocate rows
-      } catch (const exception &e) { cout<<"4,"<<e.what()<<endl; }
-      for (int k=0; k<num_rows; k++) arr[i][j][k]=0; // set values to 0
-    }
+/*----------------*
+ * MAIN ALGORITHM *
+ *----------------*/
 
-  }
+// if vertex_file_path=="" the vertex sample is decided by hash as each vertex first appears, so no vertex file (or pre-pass) is needed
+void single_pass_insertion_deletion_stream(int c, int d, int num_vertices, string edge_file_path, string vertex_file_path, set<vertex>& neighbourhood, vertex& root) {
+  // prepare samplers
+  sampler_bank bank;
+  choose_bank_parameters(bank,c,d,num_vertices);
+  vertex_sampling sampling=initialise_vertex_sampling(vertex_file_path,num_vertices,bank.vertex_sample_size);
+  // neighbours are hashed once per block update, level k keeps neighbours with unique hash < 2^(63-k), a 1/2^(k+1) fraction
+  initialise_sampler_bank(bank,mt19937_64(chrono::system_clock::now().time_since_epoch().count())());
+  update_buffer buffer;
+  initialise_update_buffer(buffer,bank,false);
 
-  return arr;
-}
+  ifstream edge_stream(edge_file_path);
 
- // allocate space of 2d array of hash parameters
-hash_params** initalise_2d_hash_params_array(int num_cols, int num_rows) {
-  hash_params** arr = (hash_params**) malloc(num_cols * sizeof(hash_params*)); // allocate cols
-  // allocate rows
-  for (int i=0; i<num_cols; i++) arr[i]=(hash_params*) malloc(num_rows * sizeof(hash_params));
-  return arr;
-}
+  cout<<"STREAM STARTING"<<endl;
+  string line; edge e;
+  int edge_counter=0;
+  BYTES+=sizeof(string)+sizeof(edge)+sizeof(int);
+  while (getline(edge_stream,line)) {
+    edge_counter+=1;
+    if (edge_counter%1000==0) cout<<"\r"<<edge_counter;
 
-// free space of 3d array of long integers
-void free_3d_long_array(long*** arr, int depth, int num_cols, int num_rows) {
-  for (int d=0; d<depth; d++) {
-    for (int c=0; c<num_cols; c++) {
-      long* ptr2=arr[d][c];
-      free(ptr2);
-    }
-    long** ptr=arr[d];
-    free(ptr);
+    parse_edge(line,e);
+    if (e.value==0) continue; // malformed or blank line, endpoints are -1
+    ingest_update(bank,buffer,sampling,e.fst,e.snd,e.value); // update every l0 sampler of each sampled endpoint
+    ingest_update(bank,buffer,sampling,e.snd,e.fst,e.value);
   }
-}
+  apply_update_batch(bank,buffer); // rest of stream
+  cout<<"\rDONE                                             "<<endl; // spaces to "clear" line
+  print_vertex_sample(bank);
 
-// free space of 2d array of hash parameters
-void free_2d_hash_params_array(hash_params** arr, int num_cols, int num_rows) {
-  for (int c=0; c<num_cols; c++) {
-    hash_params* ptr=arr[c];
-    free(ptr);
+  // return first neighbourhood of size > d/c
+  if (!find_neighbourhood(bank,d/c,num_vertices,false,true,neighbourhood,root)) {
+    cout<<"\rFAILED to find neighbourhood";
+    neighbourhood.clear();
+    vertex* p=&root;
+    p=nullptr;
   }
-}
-
-// return variance of values in a vector
-double variance(vector<uint64_t> vals) {
-  if (vals.size()<=1) return 0;
-  double var=0;
-  double mean=accumulate(vals.begin(),vals.end(),0)/vals.size();
-
-  for (vector<uint64_t>::iterator it=vals.begin(); it!=vals.end(); it++) var+=(*it-mean)*(*it-mean);
-  var/=(vals.size()-1);
-
-  return var;
-}
-
-uint64_t mean(vector<uint64_t> vals) {
-  if (vals.size()==0) return 0;
-  uint64_t sum=0;
-  for (vector<uint64_t>::iterator it=vals.begin(); it!=vals.end(); it++) sum+=*it;
 
-  return sum/vals.size();
+  // free space
+  free_sampler_bank(bank);
+  free_update_buffer(buffer);
 }
@@ -0,0 +1,385 @@
+/*
+ *  1-sparse cells which are exact for any 64-bit key, compared with the (phi,iota,tau) cells of ibltRecovery.cpp.
+ *
+ *  The current cells keep the sum of weights (phi), the weighted sum of keys (iota) & the weighted sum of squared keys (tau) in longs
+ *    & take int keys. Keys above 2^31 are truncated & tau overflows once key^2 passes 2^63, so with 64-bit keys (hashed user ids,
+ *    or edge ids from n^2 in insertionDeletionEdgeSampling.cpp) pure cells give the wrong key & mixed cells can pass iota^2=phi*tau.
+ *
+ *  A fingerprinted cell (24 bytes) keeps phi, iota mod 2^64 & tau=sum of weight*z_0^b_0*...*z_7^b_7 mod p=2^61-1, where b_0..b_7 are
+ *    the bytes of the key & z_0..z_7 are random evaluation points. Distinct keys give distinct monomials so a cell holding any other
+ *    combination of keys passes with probability at most 8*255/p (Schwartz-Zippel), whatever the keys.
+ *    z_i^b is looked up in an 8x256 table (16KB, stays in L1) so a fingerprint is 8 lookups & 7 multiplications mod p (3 deep),
+ *    computed once per update & added to the cell of every row.
+ *    A pure cell of odd weight w gives key=iota*w^-1 mod 2^64 (w=+-1 in graph streams).
+ *
+ *  main() compares the exact recoveries & wrong keys of s-sparse recovery with both cells as keys grow to 64 bits,
+ *    & the update & recovery throughput of both cells.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <fstream>
+#include <math.h>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+const uint64_t MERSENNE_61=(1ULL<<61)-1; // prime field of the fingerprints
+
+/*-----------------*
+ * DATA STRUCTURES *
+ *-----------------*/
+using key64 = uint64_t; // typemap key
+
+struct update { // entry of the vector's stream
+  key64 key;
+  int value;
+};
+
+struct fingerprint_cell { // 1-sparse cell for any 64-bit key, 24 bytes
+  long phi; // sum of weights
+  uint64_t iota; // sum of weight*key mod 2^64
+  uint64_t tau; // sum of weight*fingerprint(key) mod MERSENNE_61
+};
+
+struct fingerprint_table { // powers[i][b]=z_i^b mod MERSENNE_61, z_i is the evaluation point of byte i of a key
+  uint64_t powers[8][256];
+};
+
+struct key_hash { // multiply-shift hash of a 64-bit key to a col, shared by both cells so only the cells are compared
+  uint64_t a; // odd
+  uint64_t b;
+};
+
+/*------------*
+ * SIGNATURES *
+ *------------*/
+
+void execute_test(vector<int> sparsities, vector<int> key_bits, int trials, double gamma, string out_file);
+void benchmark_throughput(vector<int> sparsities, int key_bits, int num_updates, double gamma, string out_file);
+
+// Test streams
+vector<update> generate_sparse_stream(int num_keys, int num_deleted, int key_bits, set<key64>& keys, mt19937_64& generator);
+
+// Fingerprinted cells
+fingerprint_table generate_fingerprint_table(mt19937_64& generator);
+inline uint64_t mul_mod_61(uint64_t a, uint64_t b);
+inline uint64_t weight_mod_61(long w);
+inline uint64_t fingerprint(key64 key, fingerprint_table& table);
+uint64_t inverse_mod_64(uint64_t w);
+inline void update_fingerprint_cell(key64 key, int value, uint64_t weighted_fingerprint, fingerprint_cell& cell);
+bool verify_fingerprint_cell(fingerprint_cell& cell, fingerprint_table& table, key64& key);
+void update_fingerprint_s_sparse(key64 key, int value, int num_cols, int num_rows, key_hash* hs, fingerprint_cell* cells, fingerprint_table& table);
+set<key64> recover_fingerprint_s_sparse(int num_cols, int num_rows, fingerprint_cell* cells, fingerprint_table& table);
+
+// Current cells (as ibltRecovery.cpp)
+void update_s_sparse(key64 key, int edge_value, int num_cols, int num_rows, key_hash* hs, long** phi_s, long** iota_s, long** tau_s);
+set<key64> recover_neighbourhood(int num_cols, int num_rows, long** phi_s, long** iota_s, long** tau_s);
+bool verify_1_sparse(long phi,long iota,long tau);
+void update_1_sparse_counters(int index,int delta,int row,int col,long** phi_s,long** iota_s,long** tau_s);
+
+// Hashing
+key_hash* choose_key_hashes(int num_rows, mt19937_64& generator);
+inline int hash_key(key64 key, key_hash h, int num_cols);
+
+// Utility
+long** initalise_zero_2d_array(int num_cols, int num_rows);
+void free_2d_long_array(long** arr, int num_cols);
+
+/*------*
+ * BODY *
+ *------*/
+
+int main() {
+  double gamma=.3; // acceptable failure for s-sparse recovery
+  int trials=1000;
+
+  vector<int> sparsities={5,20,100};
+  vector<int> key_bits={20,31,40,64}; // 31 bits is the largest the current cells take
+  execute_test(sparsities,key_bits,trials,gamma,"fingerprint_recovery_results.csv");
+
+  // updates to structures which fit in L1 up to ones which do not fit in L2, keys of 31 bits so the current cells are correct
+  benchmark_throughput({5,100,1000,100000},31,10000000,gamma,"fingerprint_throughput_results.csv");
+}
+
+// for each s & size of key recover s-sparse vectors with both cells, recording the proportion recovered exactly & keys which were never inserted
+void execute_test(vector<int> sparsities, vector<int> key_bits, int trials, double gamma, string out_file) {
+  ofstream outfile(out_file);
+  outfile<<"trials,"<<trials<<endl<<"gamma,"<<gamma<<endl<<endl; // test details
+  outfile<<"s,key bits,cells,space (bytes),exact recoveries,mean keys recovered,mean wrong keys,exact recoveries (fingerprint),mean keys recovered (fingerprint),mean wrong keys (fingerprint)"<<endl; // headers
+
+  mt19937_64 generator(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+
+  for (int s : sparsities) {
+    int num_cols=2*s, num_rows=log(s/gamma);
+    if (num_rows<1) num_rows=1;
+
+    for (int bits : key_bits) {
+      int exact=0, fingerprint_exact=0;
+      uint64_t recovered=0, wrong=0, fingerprint_recovered=0, fingerprint_wrong=0;
+
+      for (int t=0; t<trials; t++) {
+        cout<<"\r"<<s<<" "<<bits<<" bits ("<<t<<"/"<<trials<<")      ";
+        set<key64> keys;
+        vector<update> stream=generate_sparse_stream(s,s,bits,keys,generator);
+        key_hash* hs=choose_key_hashes(num_rows,generator);
+
+        // current cells
+        long** phi=initalise_zero_2d_array(num_cols,num_rows);
+        long** iota=initalise_zero_2d_array(num_cols,num_rows);
+        long** tau=initalise_zero_2d_array(num_cols,num_rows);
+        for (vector<update>::iterator it=stream.begin(); it!=stream.end(); it++) update_s_sparse(it->key,it->value,num_cols,num_rows,hs,phi,iota,tau);
+        set<key64> current_keys=recover_neighbourhood(num_cols,num_rows,phi,iota,tau);
+        if (current_keys==keys) exact+=1;
+        recovered+=current_keys.size();
+        for (key64 k : current_keys) if (keys.count(k)==0) wrong+=1;
+        free_2d_long_array(phi,num_cols); free_2d_long_array(iota,num_cols); free_2d_long_array(tau,num_cols);
+
+        // fingerprinted cells on the same stream & hashes
+        fingerprint_table table=generate_fingerprint_table(generator);
+        vector<fingerprint_cell> cells(num_cols*num_rows,{0,0,0});
+        for (vector<update>::iterator it=stream.begin(); it!=stream.end(); it++) update_fingerprint_s_sparse(it->key,it->value,num_cols,num_rows,hs,cells.data(),table);
+        set<key64> fingerprint_keys=recover_fingerprint_s_sparse(num_cols,num_rows,cells.data(),table);
+        if (fingerprint_keys==keys) fingerprint_exact+=1;
+        fingerprint_recovered+=fingerprint_keys.size();
+        for (key64 k : fingerprint_keys) if (keys.count(k)==0) fingerprint_wrong+=1;
+
+        delete[] hs;
+      }
+
+      uint64_t bytes=num_cols*num_rows*sizeof(fingerprint_cell); // both cells are 3 words
+      outfile<<s<<","<<bits<<","<<num_cols*num_rows<<","<<bytes<<","<<exact/(double)trials<<","<<recovered/(double)trials<<","<<wrong/(double)trials<<","
+        <<fingerprint_exact/(double)trials<<","<<fingerprint_recovered/(double)trials<<","<<fingerprint_wrong/(double)trials<<endl;
+    }
+  }
+  cout<<"\rDONE                          "<<endl;
+  outfile.close();
+}
+
+// ns per update of num_updates random updates to one s-sparse recovery with each cell, & ns per cell to recover it
+void benchmark_throughput(vector<int> sparsities, int key_bits, int num_updates, double gamma, string out_file) {
+  ofstream outfile(out_file);
+  outfile<<"updates,"<<num_updates<<endl<<"key bits,"<<key_bits<<endl<<"gamma,"<<gamma<<endl<<endl; // test details
+  outfile<<"s,cells,space (bytes),update (nanoseconds),update (fingerprint) (nanoseconds),recovery per cell (nanoseconds),recovery per cell (fingerprint) (nanoseconds)"<<endl; // headers
+
+  mt19937_64 generator(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+  uniform_int_distribution<key64> key_distribution(1,(key_bits==64) ? UINT64_MAX : (1ULL<<key_bits)-1);
+  vector<update> updates(num_updates);
+  for (int u=0; u<num_updates; u++) updates[u]={key_distribution(generator),(generator()&1) ? 1 : -1};
+
+  for (int s : sparsities) {
+    int num_cols=2*s, num_rows=log(s/gamma);
+    if (num_rows<1) num_rows=1;
+    int num_cells=num_cols*num_rows;
+    key_hash* hs=choose_key_hashes(num_rows,generator);
+    fingerprint_table table=generate_fingerprint_table(generator);
+    uint64_t checksum=0; // keeps recovery from being optimised away
+
+    long** phi=initalise_zero_2d_array(num_cols,num_rows);
+    long** iota=initalise_zero_2d_array(num_cols,num_rows);
+    long** tau=initalise_zero_2d_array(num_cols,num_rows);
+    chrono::high_resolution_clock::time_point before=chrono::high_resolution_clock::now();
+    for (int u=0; u<num_updates; u++) update_s_sparse(updates[u].key,updates[u].value,num_cols,num_rows,hs,phi,iota,tau);
+    chrono::high_resolution_clock::time_point after=chrono::high_resolution_clock::now();
+    double update_time=chrono::duration_cast<chrono::nanoseconds>(after-before).count()/(double)num_updates;
+    before=chrono::high_resolution_clock::now();
+    checksum+=recover_neighbourhood(num_cols,num_rows,phi,iota,tau).size();
+    after=chrono::high_resolution_clock::now();
+    double recovery_time=chrono::duration_cast<chrono::nanoseconds>(after-before).count()/(double)num_cells;
+    free_2d_long_array(phi,num_cols); free_2d_long_array(iota,num_cols); free_2d_long_array(tau,num_cols);
+
+    vector<fingerprint_cell> cells(num_cells,{0,0,0});
+    before=chrono::high_resolution_clock::now();
+    for (int u=0; u<num_updates; u++) update_fingerprint_s_sparse(updates[u].key,updates[u].value,num_cols,num_rows,hs,cells.data(),table);
+    after=chrono::high_resolution_clock::now();
+    double fingerprint_update_time=chrono::duration_cast<chrono::nanoseconds>(after-before).count()/(double)num_updates;
+    before=chrono::high_resolution_clock::now();
+    checksum+=recover_fingerprint_s_sparse(num_cols,num_rows,cells.data(),table).size();
+    after=chrono::high_resolution_clock::now();
+    double fingerprint_recovery_time=chrono::duration_cast<chrono::nanoseconds>(after-before).count()/(double)num_cells;
+
+    cout<<s<<": UPDATE "<<update_time<<"ns, FINGERPRINT "<<fingerprint_update_time<<"ns, RECOVERY "<<recovery_time<<"ns/cell, FINGERPRINT "<<fingerprint_recovery_time<<"ns/cell ("<<checksum<<")"<<endl;
+    outfile<<s<<","<<num_cells<<","<<num_cells*sizeof(fingerprint_cell)<<","<<update_time<<","<<fingerprint_update_time<<","<<recovery_time<<","<<fingerprint_recovery_time<<endl;
+    delete[] hs;
+  }
+  outfile.close();
+}
+
+/*--------------*
+ * TEST STREAMS *
+ *--------------*/
+
+// stream which leaves num_keys non-zero entries of key_bits bits, num_deleted other keys are inserted then deleted
+vector<update> generate_sparse_stream(int num_keys, int num_deleted, int key_bits, set<key64>& keys, mt19937_64& generator) {
+  uniform_int_distribution<key64> distribution(1,(key_bits==64) ? UINT64_MAX : (1ULL<<key_bits)-1);
+  set<key64> used;
+  while (used.size()<num_keys+num_deleted) used.insert(distribution(generator));
+
+  vector<key64> shuffled(used.begin(),used.end());
+  shuffle(shuffled.begin(),shuffled.end(),generator);
+
+  vector<update> stream;
+  keys.clear();
+  for (int i=0; i<shuffled.size(); i++) {
+    stream.push_back({shuffled[i],1});
+    if (i<num_keys) keys.insert(shuffled[i]);
+  }
+  for (int i=num_keys; i<shuffled.size(); i++) stream.push_back({shuffled[i],-1}); // deletions follow all insertions
+
+  return stream;
+}
+
+/*---------------------*
+ * FINGERPRINTED CELLS *
+ *---------------------*/
+
+// random evaluation point for each byte of a key & its powers
+fingerprint_table generate_fingerprint_table(mt19937_64& generator) {
+  uniform_int_distribution<uint64_t> distribution(2,MERSENNE_61-1);
+  fingerprint_table table;
+  for (int i=0; i<8; i++) {
+    uint64_t z=distribution(generator);
+    table.powers[i][0]=1;
+    for (int b=1; b<256; b++) table.powers[i][b]=mul_mod_61(table.powers[i][b-1],z);
+  }
+  return table;
+}
+
+// a*b mod 2^61-1, the 122-bit product is folded at bit 61 since 2^61=1 mod p
+inline uint64_t mul_mod_61(uint64_t a, uint64_t b) {
+  unsigned __int128 x=(unsigned __int128)a*b;
+  uint64_t r=(uint64_t)(x&MERSENNE_61)+(uint64_t)(x>>61);
+  r=(r&MERSENNE_61)+(r>>61);
+  return (r>=MERSENNE_61) ? r-MERSENNE_61 : r;
+}
+
+// weight as an element of the field
+inline uint64_t weight_mod_61(long w) {
+  long r=w%(long)MERSENNE_61;
+  return (r<0) ? r+MERSENNE_61 : r;
+}
+
+// z_0^b_0*...*z_7^b_7 for the bytes b_0..b_7 of key, multiplied as a tree so the chain of dependent multiplications is 3 long
+inline uint64_t fingerprint(key64 key, fingerprint_table& table) {
+  uint64_t f[8];
+  for (int i=0; i<8; i++) f[i]=table.powers[i][(key>>(8*i))&0xFF];
+  return mul_mod_61(mul_mod_61(mul_mod_61(f[0],f[1]),mul_mod_61(f[2],f[3])),mul_mod_61(mul_mod_61(f[4],f[5]),mul_mod_61(f[6],f[7])));
+}
+
+// inverse of odd w mod 2^64 by Newton's iteration, each step doubles the correct low bits (w*w=1 mod 8 so 3 bits to start)
+uint64_t inverse_mod_64(uint64_t w) {
+  uint64_t x=w;
+  for (int i=0; i<5; i++) x*=2-w*x;
+  return x;
+}
+
+// update counters with new entry, weighted_fingerprint=value*fingerprint(key) mod p & iota wraps mod 2^64
+inline void update_fingerprint_cell(key64 key, int value, uint64_t weighted_fingerprint, fingerprint_cell& cell) {
+  cell.phi+=value;
+  cell.iota+=(uint64_t)(long)value*key;
+  uint64_t t=cell.tau+weighted_fingerprint;
+  cell.tau=(t>=MERSENNE_61) ? t-MERSENNE_61 : t;
+}
+
+// cell holds a single key iff tau=phi*fingerprint(key) for key=iota/phi, key is set if so
+// even weights cannot be divided out of iota mod 2^64 so their cells are never recovered (weights are +-1 in graph streams)
+bool verify_fingerprint_cell(fingerprint_cell& cell, fingerprint_table& table, key64& key) {
+  if ((cell.phi&1)==0) return false;
+  key=cell.iota*inverse_mod_64(cell.phi);
+  return cell.tau==mul_mod_61(weight_mod_61(cell.phi),fingerprint(key,table));
+}
+
+// update one cell in each row, cells of a col are adjacent
+void update_fingerprint_s_sparse(key64 key, int value, int num_cols, int num_rows, key_hash* hs, fingerprint_cell* cells, fingerprint_table& table) {
+  uint64_t weighted_fingerprint=mul_mod_61(weight_mod_61(value),fingerprint(key,table));
+  for (int r=0; r<num_rows; r++) update_fingerprint_cell(key,value,weighted_fingerprint,cells[hash_key(key,hs[r],num_cols)*num_rows+r]);
+}
+
+// keys of the cells which hold a single key
+set<key64> recover_fingerprint_s_sparse(int num_cols, int num_rows, fingerprint_cell* cells, fingerprint_table& table) {
+  set<key64> keys;
+  key64 key;
+  for (int i=0; i<num_cols*num_rows; i++) {
+    if (cells[i].phi!=0 && verify_fingerprint_cell(cells[i],table,key)) keys.insert(key);
+  }
+  return keys;
+}
+
+/*---------------*
+ * CURRENT CELLS *
+ *---------------*/
+
+// update 1-sparse counters of the s-sparse recovery, the counters take the key as an int as in ibltRecovery.cpp
+void update_s_sparse(key64 key, int edge_value, int num_cols, int num_rows, key_hash* hs, long** phi_s, long** iota_s, long** tau_s) {
+  for (int r=0; r<num_rows; r++) { // decide which sampler in each row to update
+    int c=hash_key(key,hs[r],num_cols); // col to update
+    update_1_sparse_counters(key,edge_value,r,c,phi_s,iota_s,tau_s);
+  }
+}
+
+// recover keys from s-sparse recovery counters
+set<key64> recover_neighbourhood(int num_cols, int num_rows, long** phi_s, long** iota_s, long** tau_s) {
+  set<key64> keys;
+  for (int c=0; c<num_cols; c++) {
+    for (int r=0; r<num_rows; r++) {
+      if (verify_1_sparse(phi_s[c][r],iota_s[c][r],tau_s[c][r])) {
+        keys.insert(iota_s[c][r]/phi_s[c][r]);
+  }}}
+  return keys;
+}
+
+// update counters with new edge
+void update_1_sparse_counters(int index,int delta,int row,int col,long** phi_s,long** iota_s,long** tau_s) {
+  phi_s[col][row] +=delta;
+  iota_s[col][row]+=delta*index;
+  tau_s[col][row] +=delta*(long)index*index;
+}
+
+// verify if array is 1_sparse
+bool verify_1_sparse(long phi,long iota,long tau) {
+  if (iota*iota==phi*tau && phi!=0) return true;
+  return false;
+}
+
+/*---------*
+ * HASHING *
+ *---------*/
+
+// hash of each row
+key_hash* choose_key_hashes(int num_rows, mt19937_64& generator) {
+  key_hash* hs=new key_hash[num_rows];
+  for (int r=0; r<num_rows; r++) hs[r]={generator()|1,generator()};
+  return hs;
+}
+
+// col of key, top 32 bits of a*key+b scaled to num_cols
+inline int hash_key(key64 key, key_hash h, int num_cols) {
+  return ((h.a*key+h.b)>>32)*num_cols>>32;
+}
+
+/*-----------*
+ * UTILITIES *
+ *-----------*/
+
+// initalise 2d array with zero in every index
+long** initalise_zero_2d_array(int num_cols, int num_rows) {
+  long** arr = (long**) malloc(num_cols * sizeof(long*)); // allocate cols
+
+  for (int i=0; i<num_cols; i++) {
+    arr[i]=(long*) malloc(num_rows * sizeof(long)); // allocate rows
+    for (int j=0; j<num_rows; j++) arr[i][j]=0; // set values to 0
+  }
+
+  return arr;
+}
+
+// free space of 2d array of long integers
+void free_2d_long_array(long** arr, int num_cols) {
+  for (int c=0; c<num_cols; c++) free(arr[c]);
+  free(arr);
+}
@@ -0,0 +1,323 @@
+/*
+ *  Implementation of s-sparse recovery using an invertible Bloom lookup table (IBLT) which is decoded by peeling.
+ *
+ *  Each key is added to one cell in each of num_rows subtables (one hash function per subtable).
+ *    Each cell stores the sum of weights (phi), the weighted sum of keys (iota) & the weighted sum of squared keys (tau).
+ *    A cell is pure if it holds a single key, which is recovered & subtracted from its other cells,
+ *    possibly making them pure. This is repeated until no pure cells remain.
+ *    Recovery succeeds if every cell is empty at the end.
+ *
+ *  With 3 subtables peeling recovers up to s keys from ~1.3s cells with high probability (for large s),
+ *    compared to 2s*log(s/gamma) cells for the s-sparse recovery in sSparseRecovery.cpp.
+ *
+ *  main() benchmarks the space & success rate of both structures on random sparse vectors built from
+ *    a stream of insertions & deletions.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <math.h>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int P=1073741789; // >2^30
+int IBLT_ROWS=3; // number of subtables (hash functions) in the IBLT
+double IBLT_CELLS=1.3; // cells per key to recover
+
+/*-----------------*
+ * DATA STRUCTURES *
+ *-----------------*/
+using vertex = int; // typemap vertex
+
+struct hash_params { // parameters for hash function
+  unsigned long a;
+  unsigned long b;
+  unsigned long m;
+};
+
+struct update { // entry of the vector's stream
+  vertex key;
+  int value;
+};
+
+/*------------*
+ * SIGNATURES *
+ *------------*/
+
+void execute_test(vector<int> sparsities, vector<double> cell_ratios, int trials, int num_vertices, double gamma, string out_file);
+
+// Test streams
+vector<update> generate_sparse_stream(int num_keys, int num_deleted, int num_vertices, set<vertex>& keys, default_random_engine& generator);
+
+// IBLT
+void iblt_geometry(int s, double cell_ratio, int& num_cols, int& num_rows);
+set<vertex> peel_iblt(int num_cols, int num_rows, hash_params* ps_s, long** phi_s, long** iota_s, long** tau_s, bool& complete);
+
+// s-sparse
+hash_params* choose_hash_functions(int num_cols, int num_rows);
+void update_s_sparse(vertex endpoint, int edge_value, int num_rows, hash_params* ps_s, long** phi_s, long** iota_s, long** tau_s);
+set<vertex> recover_neighbourhood(int num_cols, int num_rows, long** phi_s, long** iota_s, long** tau_s);
+
+// 1-sparse
+bool verify_1_sparse(long phi,long iota,long tau);
+void update_1_sparse_counters(int index,int delta,int row,int col,long** phi_s,long** iota_s,long** tau_s);
+
+// Hashing
+hash_params generate_hash(int m);
+int hash_function(int key, hash_params ps);
+
+// Utility
+long** initalise_zero_2d_array(int num_cols, int num_rows);
+void free_2d_long_array(long** arr, int num_cols);
+
+/*------*
+ * BODY *
+ *------*/
+
+int main() {
+  int num_vertices=747; // keys are taken from 1..num_vertices (facebook_deletion)
+  double gamma=.3; // acceptable failure for s-sparse recovery
+  int trials=1000;
+
+  vector<int> sparsities={2,5,10,20,50,100,200};
+  vector<double> cell_ratios={IBLT_CELLS,1.5,2.0}; // cells per key of the IBLTs compared
+  execute_test(sparsities,cell_ratios,trials,num_vertices,gamma,"iblt_recovery_results.csv");
+}
+
+// for each s recover s-sparse vectors with both structures, recording space & proportion recovered exactly
+void execute_test(vector<int> sparsities, vector<double> cell_ratios, int trials, int num_vertices, double gamma, string out_file) {
+  ofstream outfile(out_file);
+  outfile<<"n,"<<num_vertices<<endl<<"trials,"<<trials<<endl<<"gamma,"<<gamma<<endl<<"iblt rows,"<<IBLT_ROWS<<endl<<endl; // test details
+  outfile<<"s,structure,cells,space (bytes),exact recoveries,partial recoveries (iblt),mean keys recovered"<<endl; // headers
+
+  default_random_engine generator;
+  generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+
+  for (vector<int>::iterator s_it=sparsities.begin(); s_it!=sparsities.end(); s_it++) {
+    int s=*s_it;
+
+    // geometry of both structures
+    int ss_cols=2*s, ss_rows=log(s/gamma);
+    if (ss_rows<1) ss_rows=1;
+    int num_iblts=cell_ratios.size();
+    vector<int> iblt_cols(num_iblts), iblt_rows(num_iblts);
+    for (int x=0; x<num_iblts; x++) iblt_geometry(s,cell_ratios[x],iblt_cols[x],iblt_rows[x]);
+
+    int ss_exact=0; uint64_t ss_recovered=0;
+    vector<int> iblt_exact(num_iblts,0), iblt_partial(num_iblts,0);
+    vector<uint64_t> iblt_recovered(num_iblts,0);
+
+    for (int t=0; t<trials; t++) {
+      cout<<"\r"<<s<<" ("<<t<<"/"<<trials<<")      ";
+      set<vertex> keys;
+      vector<update> stream=generate_sparse_stream(s,s,num_vertices,keys,generator);
+
+      // current s-sparse recovery
+      long** ss_phi=initalise_zero_2d_array(ss_cols,ss_rows);
+      long** ss_iota=initalise_zero_2d_array(ss_cols,ss_rows);
+      long** ss_tau=initalise_zero_2d_array(ss_cols,ss_rows);
+      hash_params* ss_ps=choose_hash_functions(ss_cols,ss_rows);
+      for (vector<update>::iterator it=stream.begin(); it!=stream.end(); it++) update_s_sparse(it->key,it->value,ss_rows,ss_ps,ss_phi,ss_iota,ss_tau);
+
+      set<vertex> ss_keys=recover_neighbourhood(ss_cols,ss_rows,ss_phi,ss_iota,ss_tau);
+      if (ss_keys==keys) ss_exact+=1;
+      ss_recovered+=ss_keys.size();
+
+      free_2d_long_array(ss_phi,ss_cols); free_2d_long_array(ss_iota,ss_cols); free_2d_long_array(ss_tau,ss_cols);
+      delete[] ss_ps;
+
+      // IBLTs on the same stream
+      for (int x=0; x<num_iblts; x++) {
+        long** iblt_phi=initalise_zero_2d_array(iblt_cols[x],iblt_rows[x]);
+        long** iblt_iota=initalise_zero_2d_array(iblt_cols[x],iblt_rows[x]);
+        long** iblt_tau=initalise_zero_2d_array(iblt_cols[x],iblt_rows[x]);
+        hash_params* iblt_ps=choose_hash_functions(iblt_cols[x],iblt_rows[x]);
+        for (vector<update>::iterator it=stream.begin(); it!=stream.end(); it++) update_s_sparse(it->key,it->value,iblt_rows[x],iblt_ps,iblt_phi,iblt_iota,iblt_tau);
+
+        bool complete;
+        set<vertex> iblt_keys=peel_iblt(iblt_cols[x],iblt_rows[x],iblt_ps,iblt_phi,iblt_iota,iblt_tau,complete);
+        if (complete && iblt_keys==keys) iblt_exact[x]+=1;
+        else if (iblt_keys.size()!=0) iblt_partial[x]+=1;
+        iblt_recovered[x]+=iblt_keys.size();
+
+        free_2d_long_array(iblt_phi,iblt_cols[x]); free_2d_long_array(iblt_iota,iblt_cols[x]); free_2d_long_array(iblt_tau,iblt_cols[x]);
+        delete[] iblt_ps;
+      }
+    }
+
+    uint64_t ss_bytes=3*ss_cols*ss_rows*sizeof(long)+ss_rows*sizeof(hash_params);
+    outfile<<s<<",s-sparse,"<<ss_cols*ss_rows<<","<<ss_bytes<<","<<ss_exact/(double)trials<<",,"<<ss_recovered/(double)trials<<endl;
+    for (int x=0; x<num_iblts; x++) {
+      uint64_t iblt_bytes=3*iblt_cols[x]*iblt_rows[x]*sizeof(long)+iblt_rows[x]*sizeof(hash_params);
+      outfile<<s<<",iblt "<<cell_ratios[x]<<"s,"<<iblt_cols[x]*iblt_rows[x]<<","<<iblt_bytes<<","<<iblt_exact[x]/(double)trials<<","<<iblt_partial[x]/(double)trials<<","<<iblt_recovered[x]/(double)trials<<endl;
+    }
+  }
+  cout<<"\rDONE                 "<<endl;
+  outfile.close();
+}
+
+/*--------------*
+ * TEST STREAMS *
+ *--------------*/
+
+// stream which leaves num_keys non-zero entries, num_deleted other keys are inserted then deleted at random points
+vector<update> generate_sparse_stream(int num_keys, int num_deleted, int num_vertices, set<vertex>& keys, default_random_engine& generator) {
+  uniform_int_distribution<int> distribution(1,num_vertices);
+  set<vertex> used;
+  while (used.size()<num_keys+num_deleted) used.insert(distribution(generator));
+
+  vector<vertex> shuffled(used.begin(),used.end());
+  shuffle(shuffled.begin(),shuffled.end(),generator);
+
+  vector<update> stream;
+  keys.clear();
+  for (int i=0; i<shuffled.size(); i++) {
+    stream.push_back({shuffled[i],1});
+    if (i<num_keys) keys.insert(shuffled[i]);
+  }
+  for (int i=num_keys; i<shuffled.size(); i++) stream.push_back({shuffled[i],-1}); // deletions follow all insertions
+
+  return stream;
+}
+
+/*------*
+ * IBLT *
+ *------*/
+
+// IBLT_ROWS subtables with enough cols for cell_ratio*s cells in total
+void iblt_geometry(int s, double cell_ratio, int& num_cols, int& num_rows) {
+  num_rows=IBLT_ROWS;
+  num_cols=ceil(cell_ratio*s/IBLT_ROWS);
+  if (num_cols<2) num_cols=2; // a single col puts every key in the same cells
+}
+
+// recover keys by peeling pure cells, complete=true iff every cell is empty afterwards
+// the counters are copied so the IBLT is unchanged
+set<vertex> peel_iblt(int num_cols, int num_rows, hash_params* ps_s, long** phi_s, long** iota_s, long** tau_s, bool& complete) {
+  vector<long> phi(num_cols*num_rows), iota(num_cols*num_rows), tau(num_cols*num_rows);
+  deque<int> pure; // indices of cells which may be pure
+  for (int c=0; c<num_cols; c++) {
+    for (int r=0; r<num_rows; r++) {
+      int i=c*num_rows+r;
+      phi[i]=phi_s[c][r]; iota[i]=iota_s[c][r]; tau[i]=tau_s[c][r];
+      if (phi[i]!=0) pure.push_back(i);
+  }}
+
+  set<vertex> keys;
+  while (!pure.empty()) {
+    int i=pure.front(); pure.pop_front();
+    if (!verify_1_sparse(phi[i],iota[i],tau[i])) continue;
+    long value=phi[i];
+    vertex key=iota[i]/value;
+    if (hash_function(key,ps_s[i%num_rows])!=i/num_rows) continue; // key does not belong in this cell so cell is not pure
+
+    keys.insert(key);
+    for (int r=0; r<num_rows; r++) { // remove key from each of its cells
+      int k=hash_function(key,ps_s[r])*num_rows+r;
+      phi[k]-=value; iota[k]-=value*key; tau[k]-=value*(long)key*key;
+      if (phi[k]!=0) pure.push_back(k);
+    }
+  }
+
+  complete=true;
+  for (int i=0; i<num_cols*num_rows && complete; i++) if (phi[i]!=0 || iota[i]!=0 || tau[i]!=0) complete=false;
+  return keys;
+}
+
+/*-------------------*
+ * s-SPARSE RECOVERY *
+ *-------------------*/
+
+// choose hash function for each row of s-sparse recovery
+hash_params* choose_hash_functions(int num_cols, int num_rows) {
+  hash_params* ps_s=new hash_params[num_rows];
+  for (int i=0; i<num_rows; i++) ps_s[i]=generate_hash(num_cols);
+  return ps_s;
+}
+
+// update 1-sparse counters of the s-sparse recovery (also used to update IBLT)
+void update_s_sparse(vertex endpoint, int edge_value, int num_rows, hash_params* ps_s, long** phi_s, long** iota_s, long** tau_s) {
+  for (int r=0; r<num_rows; r++) { // decide which sampler in each row to update
+    int c=hash_function(endpoint,ps_s[r]); // col to update
+    update_1_sparse_counters(endpoint,edge_value,r,c,phi_s,iota_s,tau_s);
+  }
+}
+
+// recover neighbourhood from s-sparse recovery counters
+set<vertex> recover_neighbourhood(int num_cols, int num_rows, long** phi_s, long** iota_s, long** tau_s) {
+  set<vertex> neighbourhood;
+  for (int c=0; c<num_cols; c++) {
+    for (int r=0; r<num_rows; r++) {
+      if (verify_1_sparse(phi_s[c][r],iota_s[c][r],tau_s[c][r])) {
+        neighbourhood.insert(iota_s[c][r]/phi_s[c][r]);
+  }}}
+  return neighbourhood;
+}
+
+/*-------------------*
+ * 1-SPARSE RECOVERY *
+ *-------------------*/
+
+// update counters with new edge
+void update_1_sparse_counters(int index,int delta,int row,int col,long** phi_s,long** iota_s,long** tau_s) {
+  phi_s[col][row] +=delta;
+  iota_s[col][row]+=delta*index;
+  tau_s[col][row] +=delta*(long)index*index;
+}
+
+// verify if array is 1_sparse
+bool verify_1_sparse(long phi,long iota,long tau) {
+  if (iota*iota==phi*tau && phi!=0) return true;
+  return false;
+}
+
+/*---------*
+ * HASHING *
+ *---------*/
+
+// generate parameters to use in hash function
+hash_params generate_hash(int m) {
+  static default_random_engine generator(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+  uniform_int_distribution<unsigned long> distribution(0,P-1);
+  hash_params ps={
+    distribution(generator),
+    distribution(generator),
+    (unsigned long)m
+  };
+  return ps;
+}
+
+// hash a key
+int hash_function(int key, hash_params ps) {
+  return ((ps.a*key+ps.b)%P)%ps.m;
+}
+
+/*-----------*
+ * UTILITIES *
+ *-----------*/
+
+// initalise 2d array with zero in every index
+long** initalise_zero_2d_array(int num_cols, int num_rows) {
+  long** arr = (long**) malloc(num_cols * sizeof(long*)); // allocate cols
+
+  for (int i=0; i<num_cols; i++) {
+    arr[i]=(long*) malloc(num_rows * sizeof(long)); // allocate rows
+    for (int j=0; j<num_rows; j++) arr[i][j]=0; // set values to 0
+  }
+
+  return arr;
+}
+
+// free space of 2d array of long integers
+void free_2d_long_array(long** arr, int num_cols) {
+  for (int c=0; c<num_cols; c++) free(arr[c]);
+  free(arr);
+}
@@ -0,0 +1,416 @@
+/*
+ *  TEST DESCRIPTION
+ *    Compares hash families for the hash which chooses the s-sparse recoveries (levels) a neighbour is passed to
+ *      & which picks the min-hash neighbour at recovery, to find the cheapest family which still samples uniformly.
+ *    l0Sampler.cpp rereads the file for every sample & l0SamplerStream.cpp keeps a map<vertex,int> per sampler,
+ *      here the file is read once & every sampler of every family is updated from that single pass.
+ *
+ *    Families (each gives a 64-bit hash, level k keeps a neighbour if the top k+1 bits of its hash are 0)
+ *      PAIRWISE       - hash_function ((a*key+b)%P), shifted up to 64 bits
+ *      TABULATION     - xor of 4 tables of 256 random words indexed by the bytes of the key (3-independent)
+ *      MULTIPLY_SHIFT - a*key+b mod 2^64, the levels read the top bits
+ *      RANDOM_TABLE   - a random word per vertex (fully random, the baseline)
+ *    The s-sparse recoveries use the same pairwise column hashes for every family so only the level hash differs.
+ *
+ *    Updates of the target are buffered during the pass & each family's bank of samplers is built & recovered
+ *      by its own thread (PARALLEL_FAMILIES, when there is a core per family). For each family the success rate,
+ *      samples outside the neighbourhood, chi-square of the sample counts against uniform over the neighbourhood
+ *      & sampler updates per second are reported.
+ *
+ *  An implementation of an L0-Sampler for a specified vertex in a graph stream.
+ *    This samples uniformly from the neighbourhood of the vertex.
+ *    Edges are provided as a stream of inputs
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <math.h>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+int P=1073741789; // >2^30
+bool PARALLEL_FAMILIES=true; // one thread per family if there is a core for each, otherwise the families run one after another so timings are not time sliced
+
+/*-----------------*
+ * DATA STRUCTURES *
+ *-----------------*/
+using vertex = int; // typemap vertex
+using time_point=chrono::high_resolution_clock::time_point;
+
+enum hash_family {PAIRWISE, TABULATION, MULTIPLY_SHIFT, RANDOM_TABLE};
+const vector<string> FAMILY_NAMES={"pairwise","tabulation","multiply_shift","random_table"};
+
+struct edge { // undirected edge
+  vertex fst;
+  vertex snd;
+  int value;
+};
+
+struct update { // update of the target's neighbourhood
+  vertex v;
+  int value;
+};
+
+struct hash_params { // parameters for hash function
+  unsigned long a;
+  unsigned long b;
+  unsigned long m;
+};
+
+struct cell { // 1-sparse recovery counters
+  long phi; // sum of weights (sum ai)
+  long iota; // weighted sum of weights (sum ai*i)
+  long tau; // squared weighted sum of weights (sum ai*(i**2))
+};
+
+struct sampler_bank { // num_samplers L0-samplers sharing one hash family
+  hash_family family;
+  int words; // words of level hash per sampler
+  vector<uint64_t> level_hashes; // [sampler][word], parameters (pairwise,multiply-shift) or tables (tabulation,random table)
+  vector<cell> cells; // [sampler][level][col][row]
+};
+
+struct family_result {
+  int successes=0;
+  int wrong=0; // samples not in the neighbourhood
+  double chi_square=0;
+  double p_value=0;
+  double update_time=0; // seconds
+  double recovery_time=0;
+  map<vertex,int> sample_count;
+};
+
+/*------------*
+ * SIGNATURES *
+ *------------*/
+
+void execute_test(string file_path, vertex target, int num_vertices, double delta, double gamma, int num_samplers, vector<hash_family> families, string out_file);
+
+// Stream
+vector<update> read_target_updates(string file_path, vertex target);
+map<vertex,int> true_neighbourhood(vector<update>& updates);
+
+// Sampler banks
+void run_family(sampler_bank& bank, vector<update>* updates, hash_params* ps_s, int num_samplers, int num_vertices, int s, int j, int num_cols, int num_rows, uint64_t seed, family_result* result);
+void initialise_level_hashes(sampler_bank& bank, int num_samplers, int num_vertices, mt19937_64& generator);
+inline uint64_t level_hash(vertex v, hash_family family, uint64_t* ps);
+void update_sampler(vertex v, int value, uint64_t h, int j, int num_cols, int num_rows, hash_params* ps_s, cell* cells);
+vertex sample_sampler(int level, int s, int num_cols, int num_rows, hash_family family, uint64_t* ps, cell* cells);
+void uniformity(map<vertex,int>& neighbourhood, family_result& result);
+
+// 1-sparse
+bool verify_1_sparse(long phi,long iota,long tau);
+
+// Hashing
+hash_params generate_hash(int m, mt19937_64& generator);
+int hash_function(int key, hash_params ps);
+
+// Utility
+void parse_edge(string str, edge& e);
+int identify_endpoint(edge e,vertex target);
+void write_to_file(string outfile_path, map<vertex,int>& edge_count);
+
+/*------*
+ * BODY *
+ *------*/
+
+int main() {
+  // details of graph to perform on
+  string file_path="../../../data/facebook_deletion.edges";
+  vertex target=1;
+  int num_vertices=747;
+
+  // constraints on s-sparse recovery
+  double delta=0.25; // acceptable failure for L0
+  double gamma=.1; // acceptable failure for s-sparse recovery
+
+  int num_samplers=10000; // per family
+  execute_test(file_path,target,num_vertices,delta,gamma,num_samplers,{PAIRWISE,TABULATION,MULTIPLY_SHIFT,RANDOM_TABLE},"hash_family_results.csv");
+}
+
+// build num_samplers samplers per family from one pass of the stream & compare uniformity, success & throughput
+void execute_test(string file_path, vertex target, int num_vertices, double delta, double gamma, int num_samplers, vector<hash_family> families, string out_file) {
+  // same s,j,num_cols,num_rows for every sampler
+  int s=1/delta; // sparsity to recover at
+  int j=log2(num_vertices); // number of s-sparse recoveries to run
+  int num_cols=2*s;
+  int num_rows=log(s/gamma);
+
+  time_point before=chrono::high_resolution_clock::now();
+  vector<update> updates=read_target_updates(file_path,target);
+  time_point after=chrono::high_resolution_clock::now();
+  map<vertex,int> neighbourhood=true_neighbourhood(updates);
+  cout<<"STREAM READ ("<<chrono::duration_cast<chrono::milliseconds>(after-before).count()<<"ms), "<<updates.size()<<" updates of "<<target<<", degree "<<neighbourhood.size()<<endl;
+
+  // column hashes are shared so only the level hash differs between families
+  mt19937_64 generator(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+  hash_params* ps_s=new hash_params[num_samplers*j*num_rows]; // [sampler][level][row]
+  for (int i=0; i<num_samplers*j*num_rows; i++) ps_s[i]=generate_hash(num_cols,generator);
+
+  vector<sampler_bank> banks(families.size());
+  vector<family_result> results(families.size());
+  bool parallel=PARALLEL_FAMILIES && thread::hardware_concurrency()>=families.size();
+  vector<thread> threads;
+  for (int f=0; f<families.size(); f++) {
+    banks[f].family=families[f];
+    if (parallel) threads.push_back(thread(run_family,ref(banks[f]),&updates,ps_s,num_samplers,num_vertices,s,j,num_cols,num_rows,generator(),&results[f]));
+    else run_family(banks[f],&updates,ps_s,num_samplers,num_vertices,s,j,num_cols,num_rows,generator(),&results[f]);
+  }
+  for (thread& t : threads) t.join();
+
+  ofstream outfile(out_file);
+  outfile<<"samplers,"<<num_samplers<<endl<<"delta,"<<delta<<endl<<"gamma,"<<gamma<<endl<<"updates,"<<updates.size()<<endl<<"degree,"<<neighbourhood.size()<<endl<<"parallel,"<<parallel<<endl<<endl; // test details
+  outfile<<"family,hash bytes per sampler,success rate,wrong samples,chi-square,degrees of freedom,p-value,update time (s),sampler updates per second,recovery time (s)"<<endl; // headers
+
+  for (int f=0; f<families.size(); f++) {
+    family_result& result=results[f];
+    uniformity(neighbourhood,result);
+    double updates_per_second=(double)updates.size()*num_samplers/result.update_time;
+
+    cout<<FAMILY_NAMES[families[f]]<<": SUCCESSES "<<result.successes<<"/"<<num_samplers<<", WRONG "<<result.wrong<<", CHI-SQUARE "<<result.chi_square<<" (p="<<result.p_value<<"), "<<updates_per_second<<" updates/s"<<endl;
+    outfile<<FAMILY_NAMES[families[f]]<<","<<banks[f].words*sizeof(uint64_t)<<","<<result.successes/(double)num_samplers<<","<<result.wrong<<","<<result.chi_square<<","<<neighbourhood.size()-1<<","
+           <<result.p_value<<","<<result.update_time<<","<<updates_per_second<<","<<result.recovery_time<<endl;
+    write_to_file("uniform_sample_test_"+FAMILY_NAMES[families[f]]+".csv",result.sample_count);
+  }
+  outfile.close();
+  delete[] ps_s;
+}
+
+/*--------*
+ * STREAM *
+ *--------*/
+
+// single pass of the stream keeping only the updates of the target's neighbourhood
+vector<update> read_target_updates(string file_path, vertex target) {
+  vector<update> updates;
+  string line; edge e; int v;
+  ifstream edge_stream(file_path);
+  while (getline(edge_stream,line)) {
+    parse_edge(line,e);
+    v=identify_endpoint(e,target); // determine if edge is connected to target, if so what is the other endpoint
+    if (v!=-1) updates.push_back({v,e.value});
+  }
+  return updates;
+}
+
+// neighbours of the target at the end of the stream, with the weight of their edge
+map<vertex,int> true_neighbourhood(vector<update>& updates) {
+  map<vertex,int> weights, neighbourhood;
+  for (update& u : updates) weights[u.v]+=u.value;
+  for (map<vertex,int>::iterator it=weights.begin(); it!=weights.end(); it++) if (it->second!=0) neighbourhood.insert(*it);
+  return neighbourhood;
+}
+
+/*---------------*
+ * SAMPLER BANKS *
+ *---------------*/
+
+// build, update & recover every sampler of one family, timing the updates & the recovery
+void run_family(sampler_bank& bank, vector<update>* updates, hash_params* ps_s, int num_samplers, int num_vertices, int s, int j, int num_cols, int num_rows, uint64_t seed, family_result* result) {
+  mt19937_64 generator(seed);
+  initialise_level_hashes(bank,num_samplers,num_vertices,generator);
+  int sampler_cells=j*num_cols*num_rows;
+  bank.cells.assign((size_t)num_samplers*sampler_cells,{0,0,0});
+
+  int sparsity_estimate=0; // r in survery paper algorithm 2
+  time_point before=chrono::high_resolution_clock::now();
+  for (vector<update>::iterator it=updates->begin(); it!=updates->end(); it++) {
+    sparsity_estimate+=it->value;
+    for (int i=0; i<num_samplers; i++) {
+      uint64_t* ps=&bank.level_hashes[(size_t)i*bank.words];
+      update_sampler(it->v,it->value,level_hash(it->v,bank.family,ps),j,num_cols,num_rows,&ps_s[i*j*num_rows],&bank.cells[(size_t)i*sampler_cells]);
+  }}
+  time_point after=chrono::high_resolution_clock::now();
+  result->update_time=chrono::duration_cast<chrono::nanoseconds>(after-before).count()/1e9;
+
+  //  j_sample is shared
+  int j_sample=log2(sparsity_estimate)-1; // -1 since 0 indexed
+  if (j_sample<0) j_sample=0;
+  if (j_sample>=j) j_sample=j-1;
+
+  before=chrono::high_resolution_clock::now();
+  for (int i=0; i<num_samplers; i++) {
+    vertex sampled_vertex=sample_sampler(j_sample,s,num_cols,num_rows,bank.family,&bank.level_hashes[(size_t)i*bank.words],&bank.cells[(size_t)i*sampler_cells]);
+    if (sampled_vertex!=-1) {
+      result->successes+=1;
+      result->sample_count[sampled_vertex]+=1; // update number of sample occurences
+    }
+  }
+  after=chrono::high_resolution_clock::now();
+  result->recovery_time=chrono::duration_cast<chrono::nanoseconds>(after-before).count()/1e9;
+
+  vector<cell>().swap(bank.cells); // free counters, the level hashes are kept for the byte count
+}
+
+// parameters or tables of the level hash of every sampler
+void initialise_level_hashes(sampler_bank& bank, int num_samplers, int num_vertices, mt19937_64& generator) {
+  uniform_int_distribution<unsigned long> distribution(0,P-1);
+  switch (bank.family) {
+    case PAIRWISE: bank.words=2; break;
+    case TABULATION: bank.words=4*256; break;
+    case MULTIPLY_SHIFT: bank.words=2; break;
+    case RANDOM_TABLE: bank.words=num_vertices+1; break;
+  }
+  bank.level_hashes.resize((size_t)num_samplers*bank.words);
+  for (size_t i=0; i<bank.level_hashes.size(); i++) bank.level_hashes[i]=(bank.family==PAIRWISE) ? distribution(generator) : generator();
+}
+
+// 64-bit level hash of a neighbour, ps are the sampler's parameters or tables
+inline uint64_t level_hash(vertex v, hash_family family, uint64_t* ps) {
+  switch (family) {
+    case PAIRWISE: return ((ps[0]*v+ps[1])%P)<<34; // P<2^30
+    case TABULATION: return ps[v&0xFF]^ps[256+((v>>8)&0xFF)]^ps[512+((v>>16)&0xFF)]^ps[768+((v>>24)&0xFF)];
+    case MULTIPLY_SHIFT: return ps[0]*(uint64_t)v+ps[1];
+    case RANDOM_TABLE: return ps[v];
+  }
+  return 0;
+}
+
+// pass the neighbour to every level its hash reaches (top k+1 bits 0 for level k), updating one cell per row
+void update_sampler(vertex v, int value, uint64_t h, int j, int num_cols, int num_rows, hash_params* ps_s, cell* cells) {
+  int levels=(h==0) ? j : min(j,__builtin_clzll(h));
+  for (int k=0; k<levels; k++) {
+    for (int r=0; r<num_rows; r++) {
+      int c=hash_function(v,ps_s[k*num_rows+r]); // col to update
+      cell& counters=cells[(k*num_cols+c)*num_rows+r];
+      counters.phi +=value;
+      counters.iota+=value*v;
+      counters.tau +=value*(long)v*v;
+  }}
+}
+
+// recover the level's neighbourhood & return the neighbour with min hash (-1 if recovery failed)
+vertex sample_sampler(int level, int s, int num_cols, int num_rows, hash_family family, uint64_t* ps, cell* cells) {
+  set<vertex> neighbourhood;
+  for (int i=level*num_cols*num_rows; i<(level+1)*num_cols*num_rows; i++) {
+    if (verify_1_sparse(cells[i].phi,cells[i].iota,cells[i].tau)) neighbourhood.insert(cells[i].iota/cells[i].phi);
+  }
+  if (neighbourhood.size()>s || neighbourhood.size()==0) return -1; // s-sparse recovery failed
+
+  uint64_t min_hash=UINT64_MAX; vertex min_val=-1;
+  for (set<vertex>::iterator it=neighbourhood.begin(); it!=neighbourhood.end(); it++) {
+    uint64_t h_i=level_hash(*it,family,ps);
+    if (h_i<=min_hash) { // lowest yet
+      min_hash=h_i;
+      min_val=*it;
+    }
+  }
+  return min_val;
+}
+
+// chi-square of the sample counts against uniform over the neighbourhood, p-value by the Wilson-Hilferty approximation
+void uniformity(map<vertex,int>& neighbourhood, family_result& result) {
+  int in_neighbourhood=0;
+  for (map<vertex,int>::iterator it=result.sample_count.begin(); it!=result.sample_count.end(); it++) {
+    if (neighbourhood.count(it->first)) in_neighbourhood+=it->second;
+    else result.wrong+=it->second;
+  }
+  if (neighbourhood.size()<2 || in_neighbourhood==0) return;
+
+  double expected=in_neighbourhood/(double)neighbourhood.size();
+  result.chi_square=0;
+  for (map<vertex,int>::iterator it=neighbourhood.begin(); it!=neighbourhood.end(); it++) {
+    double observed=result.sample_count.count(it->first) ? result.sample_count[it->first] : 0;
+    result.chi_square+=pow(observed-expected,2)/expected;
+  }
+
+  double k=neighbourhood.size()-1; // degrees of freedom
+  double z=(cbrt(result.chi_square/k)-(1-2/(9*k)))/sqrt(2/(9*k));
+  result.p_value=.5*erfc(z/sqrt(2));
+}
+
+/*-------------------*
+ * 1-SPARSE RECOVERY *
+ *-------------------*/
+
+// verify if array is 1_sparse
+bool verify_1_sparse(long phi,long iota,long tau) {
+  if (iota*iota==phi*tau && phi!=0) return true;
+  return false;
+}
+
+/*---------*
+ * HASHING *
+ *---------*/
+
+// generate parameters to use in hash function
+hash_params generate_hash(int m, mt19937_64& generator) {
+  uniform_int_distribution<unsigned long> distribution(0,P-1);
+  hash_params ps={
+    distribution(generator),
+    distribution(generator),
+    (unsigned long)m
+  };
+  return ps;
+}
+
+// hash a key
+int hash_function(int key, hash_params ps) {
+  return ((ps.a*key+ps.b)%P)%ps.m;
+}
+
+/*-----------*
+ * UTILITIES *
+ *-----------*/
+
+// parse edge from string "v1 v2" or "(I/D) v1 v2"
+void parse_edge(string str, edge& e) {
+  int spaces=count(str.begin(),str.end(),' ');
+
+  if (spaces==2) { // insertion deletion edge
+    if (str[0]=='D') e.value=-1;
+    else e.value=1;
+    str=str.substr(2,str.size());
+  } else if (spaces==1) { // insertion edge
+    e.value=1;
+  }
+
+  string fst="",snd="";
+  bool after=false;
+
+  for (char& c:str) {
+    if (c==' ') { // seperator
+      after=true;
+    } else if (after) { // second id
+      snd+=c;
+    } else { // first id
+      fst+=c;
+    }
+  }
+
+  // Update edge values
+  try {
+    e.fst=stoi(fst);
+    e.snd=stoi(snd);
+  } catch (exception ex) {
+    e.fst=-1;
+    e.snd=-1;
+    e.value=0;
+  }
+}
+
+// returns endpoint which is not target (or -1 if target not on edge)
+int identify_endpoint(edge e,vertex target) {
+  if (e.fst==target) return e.snd;
+  else if (e.snd==target) return e.fst;
+  else return -1;
+}
+
+// write results to a file
+void write_to_file(string outfile_path, map<vertex,int>& edge_count) {
+  ofstream outfile(outfile_path);
+  outfile<<"vertex,count"<<endl;
+  for(map<vertex,int>::iterator it=edge_count.begin(); it!=edge_count.end(); it++) { // write num sampled values to file
+    outfile<<it->first<<","<<it->second<<endl;
+  }
+  outfile.close();
+}
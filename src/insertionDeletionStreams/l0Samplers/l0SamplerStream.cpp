@@ -10,6 +10,8 @@
 
 #include <algorithm>
 #include <chrono>
+#include <climits>
+#include <deque>
 #include <iostream>
 #include <fstream>
 #include <map>
@@ -21,6 +23,9 @@
 using namespace std;
 
 int P=1073741789; // >2^30
+bool USE_IBLT=false; // s-sparse recovery by peeling an IBLT of IBLT_CELLS*s cells in IBLT_ROWS rows (see ibltRecovery.cpp)
+int IBLT_ROWS=3;
+double IBLT_CELLS=1.3;
 
 /*-----------------*
  * DATA STRUCTURES *
@@ -53,6 +58,10 @@ void update_s_sparse(vertex endpoint, int edge_value, int num_rows, hash_params*
 set<vertex> recover_neighbourhood(int num_cols, int num_rows, long** phi_s, long** iota_s, long** tau_s);
 vertex recover_vertex(set<vertex> neighbourhood, int sparsity, map<int,int> hash_map);
 
+// IBLT
+void iblt_geometry(int s, int& num_cols, int& num_rows);
+set<vertex> peel_iblt(int num_cols, int num_rows, hash_params* ps_s, long** phi_s, long** iota_s, long** tau_s, bool& complete);
+
 // 1-sparse
 bool verify_1_sparse(int phi,int iota,int tau);
 void update_1_sparse_counters(int index,int delta,int row,int col,long** phi_s,long** iota_s,long** tau_s);
@@ -94,6 +103,7 @@ int main() {
   int j=log2(num_vertices); // number of s-sparse recoveries to run
   int num_cols=2*s;
   int num_rows=log(s/gamma);
+  if (USE_IBLT) iblt_geometry(s,num_cols,num_rows);
 
   cout<<"# Samplers:"<<num_samplers<<endl<<"# s-sparse:"<<j<<endl<<"# cols:"<<num_cols<<endl<<"# rows:"<<num_rows<<endl;
 
@@ -157,7 +167,11 @@ int main() {
 
   for (int i=0; i<num_samplers; i++) {
     // extract from each sampler
-    sampled_neighbourhood=recover_neighbourhood(num_cols,num_rows,phi_s[i][j_sample],iota_s[i][j_sample],tau_s[i][j_sample]);
+    if (USE_IBLT) {
+      bool complete;
+      sampled_neighbourhood=peel_iblt(num_cols,num_rows,ps_s[i][j_sample],phi_s[i][j_sample],iota_s[i][j_sample],tau_s[i][j_sample],complete);
+      if (!complete) sampled_neighbourhood.clear(); // min hash of a partial recovery is not uniform
+    } else sampled_neighbourhood=recover_neighbourhood(num_cols,num_rows,phi_s[i][j_sample],iota_s[i][j_sample],tau_s[i][j_sample]);
     vertex sampled_vertex=recover_vertex(sampled_neighbourhood,s,unique_hash_maps[i]);
 
     if (sampled_vertex!=-1) {
@@ -260,6 +274,50 @@ vertex recover_vertex(set<vertex> neighbourhood, int sparsity, map<int,int> hash
   }
 }
 
+/*------*
+ * IBLT *
+ *------*/
+
+// IBLT_ROWS rows (each with its own hash) with enough cols for IBLT_CELLS*s cells in total
+void iblt_geometry(int s, int& num_cols, int& num_rows) {
+  num_rows=IBLT_ROWS;
+  num_cols=ceil(IBLT_CELLS*s/IBLT_ROWS);
+  if (num_cols<2) num_cols=2; // a single col puts every vertex in the same cells
+}
+
+// recover neighbours by peeling pure cells, removing each recovered vertex from its other cells
+// complete=true iff every cell is empty afterwards, the counters are copied so the IBLT is unchanged
+set<vertex> peel_iblt(int num_cols, int num_rows, hash_params* ps_s, long** phi_s, long** iota_s, long** tau_s, bool& complete) {
+  vector<long> phi(num_cols*num_rows), iota(num_cols*num_rows), tau(num_cols*num_rows);
+  deque<int> pure; // indices of cells which may be pure
+  for (int c=0; c<num_cols; c++) {
+    for (int r=0; r<num_rows; r++) {
+      int i=c*num_rows+r;
+      phi[i]=phi_s[c][r]; iota[i]=iota_s[c][r]; tau[i]=tau_s[c][r];
+      if (phi[i]!=0) pure.push_back(i);
+  }}
+
+  set<vertex> neighbourhood;
+  while (!pure.empty()) {
+    int i=pure.front(); pure.pop_front();
+    if (!verify_1_sparse(phi[i],iota[i],tau[i])) continue;
+    long value=phi[i];
+    vertex v=iota[i]/value;
+    if (hash_function(v,ps_s[i%num_rows])!=i/num_rows) continue; // v does not belong in this cell so cell is not pure
+
+    neighbourhood.insert(v);
+    for (int r=0; r<num_rows; r++) { // remove v from each of its cells
+      int k=hash_function(v,ps_s[r])*num_rows+r;
+      phi[k]-=value; iota[k]-=value*v; tau[k]-=value*pow(v,2);
+      if (phi[k]!=0) pure.push_back(k);
+    }
+  }
+
+  complete=true;
+  for (int i=0; i<num_cols*num_rows && complete; i++) if (phi[i]!=0 || iota[i]!=0 || tau[i]!=0) complete=false;
+  return neighbourhood;
+}
+
 /*-------------------*
  * 1-SPARSE RECOVERY *
  *-------------------*/
@@ -0,0 +1,1322 @@
+/*
+ * Sampler bank shared by the insertion-deletion vertex sampling engines (insertionDeletionStreams*.cpp)
+ * Each engine is one translation unit which defines the configuration declared below & includes this header once,
+ * it defines non inline functions & globals so it must be included by exactly one translation unit of a program,
+ * the engines only differ in how the stream reaches their banks (one reader, producer threads, worker threads or snapshots)
+ */
+
+#ifndef SAMPLER_BANK_H
+#define SAMPLER_BANK_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <linux/mempolicy.h>
+#include <map>
+#include <math.h>
+#include <random>
+#include <set>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+// configuration, defined by the engine
+extern int P;
+extern int POOL_BLOCKS_PER_CHUNK;
+extern bool USE_IBLT;
+extern int IBLT_ROWS;
+extern double IBLT_CELLS;
+extern bool HARVEST_LEVELS;
+extern int BATCH_SIZE;
+extern int PREFETCH_DISTANCE;
+extern int RESERVOIR_CAPACITY;
+extern bool HUGE_PAGES;
+extern int NUMA_PLACEMENT;
+extern size_t HUGE_PAGE_SIZE;
+
+// measurements of the last pass, atomic as a bank may be filled by several threads
+atomic<uint64_t> BYTES; // space used atm
+atomic<uint64_t> L0_HASH_BYTES; // space used atm
+atomic<uint64_t> GENERATING_L0_HASH_TIME; // space used atm
+const uint64_t FINGERPRINT_P=(1ULL<<61)-1; // prime the fingerprints of a bank are taken mod
+
+/*-----------------*
+ * DATA STRUCTURES *
+ *-----------------*/
+
+using vertex = int; // typemap vertex
+using time_point=chrono::high_resolution_clock::time_point;
+
+struct edge { // undirected edge
+  vertex fst;
+  vertex snd;
+  int value;
+};
+
+struct hash_params { // parameters for hash function
+  unsigned long a;
+  unsigned long b;
+  unsigned long m;
+};
+
+struct block_update { // update of a sampled vertex's block, waiting in a batch
+  int block;
+  vertex v; // neighbour
+  int value;
+  uint64_t lo, hi; // 128-bit hash of neighbour
+  uint64_t fp; // fingerprint z^v of neighbour, see vertex_fingerprint
+};
+
+struct sampler_hash { // multiply-shift parameters taking the 128-bit hash of a neighbour to the hashes of one sampler
+  uint64_t a_lo, a_hi, a_b; // unique hash (chooses levels & min hash vertex)
+  uint64_t c_lo, c_hi, c_b; // col hash (16 bits per row)
+};
+
+// updates the s-sparse levels of one sampler which keep neighbour with unique hash h, cols[r]=col of row r
+using level_updater=void (*)(vertex v, int edge_value, uint64_t h, int* cols, int num_levels, int num_cols, int num_rows, long*** phi, long*** iota);
+// recovers the vertices in 1-sparse cells of one s-sparse level
+using neighbourhood_recoverer=set<vertex> (*)(int num_cols, int num_rows, long** phi_s, long** iota_s);
+
+struct sketch_geometry { // instantiation of the s-sparse functions for a fixed geometry
+  int num_cols;
+  int num_rows;
+  int num_levels;
+  level_updater update;
+  level_updater update_atomic; // adds to each cell atomically, for a bank updated by several threads at once
+  neighbourhood_recoverer recover;
+};
+
+struct update_pipeline { // hashes of the samplers between being prefetched & updated, sampler i uses slot i%depth
+  int depth; // PREFETCH_DISTANCE+1
+  uint64_t* h; // unique hash
+  int* cols; // num_rows cols per slot
+};
+
+struct counter_pool { // contiguous zeroed storage which sampler counters are taken from
+  vector<long*> chunks;
+  size_t chunk_size; // longs per chunk
+  size_t used; // longs used in last chunk
+  vector<size_t> chunk_bytes; // bytes mapped for each chunk
+};
+
+struct vertex_sampling { // which vertices are given a block
+  bool by_hash; // decided by hash as each vertex first appears, so no vertex file (or pre-pass) is needed
+  hash_params hash;
+  set<vertex> sample; // read from the vertex file if not by_hash
+};
+
+struct sampler_bank { // blocks of L0 samplers of the sampled vertices which have had an update, see choose_bank_parameters
+  int vertex_sample_size, samplers_per_l0;
+  int s, j, num_cols, num_rows; // sparsity, levels & geometry of the s-sparse recoveries of every sampler
+  uint64_t seed; // of the 128-bit hash of neighbours, shared by every block of a pass
+  sketch_geometry geometry;
+  // each sampled vertex has a block of samplers_per_l0 samplers, sampler i belongs to block i/samplers_per_l0
+  // long*** = [s-sparse][s-sparse col][s-sparse row]
+  vector<long***> phi_s, iota_s; vector<sampler_hash> ps_s; vector<int> sparsity_estimates;
+  map<vertex,int> sample_blocks; vector<vertex> block_vertices; // sampled vertex -> index of its block, or -(r+1) while in reservoir r (& reverse)
+  counter_pool pool;
+  // cells of a bank which is subtracted from (see subtract_sketch) are signed, so phi=1 does not make a cell 1-sparse (eg. +a +b -c)
+  // such a bank also keeps tau=sum ai*z^i mod FINGERPRINT_P per cell, which is z^iota for a 1-sparse cell, 0 disables
+  uint64_t fingerprint_base=0;
+  vector<long***> tau_s;
+  // a sampled vertex starts with a reservoir of every neighbour inserted so far, which becomes a sketch block on the first deletion incident to
+  // the vertex (or once full), so a pure insertion stream never pays for its samplers
+  size_t reservoir_capacity; // 0 starts every block as a sketch
+  vector<vector<vertex>> reservoirs; vector<vertex> reservoir_vertices;
+};
+
+struct update_buffer { // updates of one ingesting thread waiting to be applied to a bank
+  // sketches are linear so updates can be reordered, a batch is applied one block at a time so the block's counters stay in cache
+  vector<block_update> batch, bucketed; vector<int> bucket_ends;
+  update_pipeline pipeline;
+  bool shared; // bank is updated by other threads at the same time, counters are only ever added to so atomic adds suffice
+  // shared: the updates of a bucket are summed per sampler in a scratch sampler, which is flushed with one atomic add per non zero cell
+  counter_pool scratch_pool;
+  long*** scratch_phi; long*** scratch_iota;
+};
+
+/*------------*
+ * SIGNATURES *
+ *------------*/
+
+// Vertex sample
+vertex_sampling initialise_vertex_sampling(string vertex_file_path, int num_vertices, int sample_size);
+bool is_sampled(vertex_sampling& sampling, vertex v);
+set<vertex> generate_vertex_sample(string file_path, int num_vertices, int sample_size);
+
+// Sampler bank
+void choose_bank_parameters(sampler_bank& bank, int c, int d, int num_vertices);
+int choose_num_levels(int d, int num_vertices);
+double expected_harvest(int degree, int s, int num_levels);
+void initialise_sampler_bank(sampler_bank& bank, uint64_t seed);
+map<vertex,int>::iterator add_sampler_block(sampler_bank& bank, vertex target);
+map<vertex,int>::iterator add_reservoir(sampler_bank& bank, vertex target);
+bool ingest_update(sampler_bank& bank, update_buffer& buffer, vertex_sampling& sampling, vertex target, vertex v, int value);
+void append_sampler_bank(sampler_bank& bank, sampler_bank& other);
+void print_vertex_sample(sampler_bank& bank);
+void free_sampler_bank(sampler_bank& bank);
+
+// Updates
+void initialise_update_buffer(update_buffer& buffer, sampler_bank& bank, bool shared);
+void free_update_buffer(update_buffer& buffer);
+void queue_block_update(sampler_bank& bank, update_buffer& buffer, block_update& up);
+void apply_update_batch(sampler_bank& bank, update_buffer& buffer);
+void update_block(sampler_bank& bank, update_buffer& buffer, block_update& up);
+void flush_scratch(int num_cells, long*** scratch_phi, long*** scratch_iota, long*** phi, long*** iota);
+
+// Recovery
+bool find_neighbourhood(sampler_bank& bank, int threshold, int num_vertices, bool difference, bool verbose, set<vertex>& neighbourhood, vertex& root);
+set<vertex> decode_sampler(sampler_bank& bank, int num_vertices, bool difference, long*** phi, long*** iota, long*** tau, sampler_hash& ps, int sparsity_estimate);
+vector<int> plan_recovery(int num_blocks, int samplers_per_l0, int threshold, vector<int>& sparsity_estimates);
+
+// s-sparse
+hash_params* choose_hash_functions(int num_cols, int num_rows);
+// COLS, ROWS & LEVELS=0 use the num_cols, num_rows & num_levels given at runtime
+template<int COLS, int ROWS> set<vertex> recover_neighbourhood(int num_cols, int num_rows, long** phi_s, long** iota_s);
+template<int ROWS, int LEVELS, bool ATOMIC> void update_levels(vertex v, int edge_value, uint64_t h, int* cols, int num_levels, int num_cols, int num_rows, long*** phi, long*** iota);
+sketch_geometry choose_sketch_geometry(int num_cols, int num_rows, int num_levels);
+set<vertex> keep_hashed_to_cells(set<vertex> candidates, int level, int num_cols, int num_rows, uint64_t seed, sampler_hash ps, long** phi_s, long** iota_s, long** tau_s, uint64_t z);
+vertex recover_vertex(set<vertex> neighbourhood, int sparsity, uint64_t seed, sampler_hash ps);
+set<vertex> harvest_neighbours(int num_levels, int num_cols, int num_rows, int sparsity, int num_vertices, uint64_t seed, sampler_hash ps, neighbourhood_recoverer recover, bool difference, long*** phi_s, long*** iota_s, long*** tau_s, uint64_t z);
+
+// IBLT
+void iblt_geometry(int s, int& num_cols, int& num_rows);
+set<vertex> peel_iblt(int num_cols, int num_rows, uint64_t seed, sampler_hash ps, long** phi_s, long** iota_s, long** tau_s, uint64_t z, bool& complete);
+
+// 1-sparse
+bool verify_1_sparse(int phi,int iota);
+uint64_t fingerprint_add(uint64_t a, uint64_t b);
+uint64_t fingerprint_multiply(uint64_t a, uint64_t b);
+uint64_t fingerprint_power(uint64_t z, uint64_t e);
+uint64_t vertex_fingerprint(sampler_bank& bank, vertex v);
+void update_fingerprints(int edge_value, uint64_t fp, uint64_t h, int* cols, int num_levels, int num_cols, int num_rows, long*** tau, bool atomic);
+bool verify_fingerprint(long phi, long iota, long tau, uint64_t z);
+
+// Hashing
+hash_params generate_hash(int m);
+int hash_function(int key, hash_params ps);
+// n = num keys, m=possible hash values, hash=map from key to hash value
+uint64_t* generate_random_hash(int n, uint64_t m);
+// vertex in sample iff hash of vertex < m, m=sample_rate*P
+hash_params generate_sample_hash(double sample_rate);
+bool in_vertex_sample(vertex v, hash_params ps);
+// one 128-bit hash (lo,hi) of a neighbour per update of a block, expanded to every sampler by multiply-shift
+uint64_t mix_64(uint64_t x);
+void hash_128(uint64_t x, uint64_t seed, uint64_t& lo, uint64_t& hi);
+sampler_hash generate_sampler_hash(mt19937_64& generator);
+inline uint64_t multiply_shift(uint64_t lo, uint64_t hi, uint64_t a_lo, uint64_t a_hi, uint64_t b);
+inline uint64_t sampler_unique_hash(uint64_t lo, uint64_t hi, sampler_hash& ps);
+void sampler_cols(uint64_t lo, uint64_t hi, sampler_hash& ps, int num_rows, int num_cols, int* cols);
+
+// Utility
+void parse_edge(string str, edge& e);
+void parse_vertex(string str, vertex& v);
+hash_params** initalise_2d_hash_params_array(int num_cols, int num_rows);
+// Prefetching
+update_pipeline initialise_update_pipeline(int num_rows);
+void free_update_pipeline(update_pipeline& pipeline);
+inline void prefetch_levels(uint64_t h, int* cols, int num_levels, int num_cols, int num_rows, long*** phi, long*** iota);
+inline void prefetch_sampler(long*** phi, long*** iota, int num_cells);
+inline void prefetch_tables(vector<long***>& phi_s, vector<long***>& iota_s, int i, int last);
+// Counter pool
+void initialise_counter_pool(counter_pool& pool, size_t chunk_size);
+long* pool_allocate(counter_pool& pool, size_t size);
+long*** pool_zero_3d_array(counter_pool& pool, int depth, int num_cols, int num_rows);
+void free_pool_3d_array(long*** arr);
+void free_counter_pool(counter_pool& pool);
+// Huge pages & NUMA
+long* allocate_chunk(size_t size, size_t& mapped_size);
+void* map_plain_chunk(size_t size, size_t& mapped_size);
+void place_chunk(void* ptr, size_t size);
+unsigned long online_nodes();
+double huge_page_coverage(vector<sampler_bank>& banks);
+double variance(vector<uint64_t> vals);
+uint64_t mean(vector<uint64_t> vals);
+
+ /*------*
+ * BODY *
+ *------*/
+
+/*---------------*
+ * VERTEX SAMPLE *
+ *---------------*/
+
+// vertices are sampled by hash if vertex_file_path=="", else sample_size vertices are read from the vertex file
+vertex_sampling initialise_vertex_sampling(string vertex_file_path, int num_vertices, int sample_size) {
+  vertex_sampling sampling;
+  sampling.by_hash=(vertex_file_path=="");
+  sampling.hash=generate_sample_hash(sample_size/(double)num_vertices);
+  BYTES+=sizeof(bool)+sizeof(hash_params);
+  if (!sampling.by_hash) sampling.sample=generate_vertex_sample(vertex_file_path,num_vertices,sample_size);
+  BYTES+=sizeof(set<vertex>)+sampling.sample.size()*sizeof(vertex);
+  return sampling;
+}
+
+bool is_sampled(vertex_sampling& sampling, vertex v) {
+  return (sampling.by_hash) ? in_vertex_sample(v,sampling.hash) : sampling.sample.count(v)>0;
+}
+
+// Generate sample of vertices
+set<vertex> generate_vertex_sample(string file_path, int num_vertices, int sample_size) {
+  // chose indices of vertices
+  set<vertex> indices;
+  default_random_engine generator;
+  generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+  uniform_int_distribution<int> distribution(0,num_vertices-1);
+  while (indices.size()<sample_size) { // set only contains unique items
+    int i=distribution(generator); // generate new value
+    indices.insert(i);
+  }
+
+  // run through stream pic out indices
+  ifstream vertex_stream(file_path);
+  set<vertex> sample;
+  string line; vertex v; int counter=0;
+  set<vertex>::iterator it=indices.begin();
+
+  while (getline(vertex_stream,line)) {
+    if (*it==counter) { // sample vertex
+      parse_vertex(line,v);
+      sample.insert(v);
+      it++;
+      if (it==indices.end()) break;
+    }
+    counter++; // increment line count
+  }
+
+  return sample;
+}
+
+/*--------------*
+ * SAMPLER BANK *
+ *--------------*/
+
+// sample size, samplers per block & s-sparse geometry of a pass, nothing is allocated
+void choose_bank_parameters(sampler_bank& bank, int c, int d, int num_vertices) {
+  // L0 sampling parameters
+  double delta=0.2, gamma=0.3; // success_rate ~= P(L0 sampler returning a vertex given delta & gamma)
+
+  // calculate model feature
+  bank.vertex_sample_size=log(num_vertices); // TODO play with
+  //bank.vertex_sample_size=(1>(d/pow(c,2))) ? sqrt(num_vertices) : sqrt(num_vertices)*(d/pow(c,2)); // TODO play with
+  //bank.vertex_sample_size=(log(num_vertices)>((log(num_vertices)*d)/pow(c,4))) ? log(num_vertices) : ((log(num_vertices)*d)/pow(c,4));
+  //bank.samplers_per_l0=(d/c)*log(num_vertices); // TODO play with these
+  double success_rate=0.85, p=(c-1)/(double)d; // p: chance one L0 sample is a given neighbour of a vertex of degree d/(c-1)
+
+  // sampler parameters
+  bank.s=1/delta; // sparsity to recover at
+  bank.j=choose_num_levels(d,num_vertices); // number of s-sparse recoveries to run
+  bank.num_cols=2*bank.s;
+  bank.num_rows=log(bank.s/gamma);
+  if (USE_IBLT) iblt_geometry(bank.s,bank.num_cols,bank.num_rows);
+
+  // a harvested sampler returns a uniform subset of expected_harvest neighbours rather than one, so a given neighbour is missed w.p. 1-harvest*p
+  // samplers hash independently so misses multiply, as they do for L0 samples, & the same number of samplers misses it w.p. 0.1
+  if (HARVEST_LEVELS) p=min(1.0,expected_harvest(ceil(1/p),bank.s,bank.j)*p);
+  bank.samplers_per_l0=(p>=1) ? 1 : ceil((1/success_rate)*log(1-.9)/log(1-p));
+
+  cout<<"Vertex sample size:"<<bank.vertex_sample_size<<endl<<"Samplers per vertex:"<<bank.samplers_per_l0<<endl;
+  cout<<"d/c="<<d/c<<endl;
+  cout<<"Sparsity of s-sparse:"<<bank.s<<endl<<"# s-sparse per L0:"<<bank.j<<endl<<"# cols per s-sparse:"<<bank.num_cols<<endl<<"# rows per s-sparse:"<<bank.num_rows<<endl;
+}
+
+// number of s-sparse levels per sampler, sparsity of a sampler is at most d so level log2(d)-1 is the deepest needed
+// one extra (overflow) level is kept for vertices whose degree exceeds the bound
+int choose_num_levels(int d, int num_vertices) {
+  int levels=(int)log2(d)+1;
+  if (levels>(int)log2(num_vertices)) levels=log2(num_vertices); // no more than needed for any vertex
+  if (levels<1) levels=1;
+  return levels;
+}
+
+// expected # neighbours harvest_neighbours returns from a sampler of a vertex of degree, level k keeps a neighbour w.p. 2^-(k+1)
+// levels are nested so the count of level k is binomial(count of level k-1,1/2) & the harvest is the first level with <=s neighbours
+// counts above 64s are halved exactly (their spread is negligible at that size) so the distribution is over <=64s+1 counts
+double expected_harvest(int degree, int s, int num_levels) {
+  int k=0; double n=degree;
+  while (k<num_levels && n/2>64*s) {n/=2; k++;}
+  if (k==num_levels) return 0;
+  vector<double> counts(64*s+1,0.0), next(64*s+1,0.0); // distribution of the count of the last level, over those which did not decode
+  counts[min((int)round(n),64*s)]=1;
+  double harvest=0;
+  for (; k<num_levels; k++) {
+    fill(next.begin(),next.end(),0.0);
+    for (int m=0; m<counts.size(); m++) {
+      if (counts[m]==0) continue;
+      for (int x=0; x<=m; x++) next[x]+=counts[m]*exp(lgamma(m+1)-lgamma(x+1)-lgamma(m-x+1)-m*log(2));
+    }
+    for (int x=0; x<=s; x++) {harvest+=x*next[x]; next[x]=0;} // level decodes, deeper levels are subsets of it
+    swap(counts,next);
+  }
+  return harvest;
+}
+
+// empty bank with the parameters chosen by choose_bank_parameters, neighbours are hashed once per block update with seed
+// a block is only allocated once its vertex has an incident update, all zero sketches recover nothing so unallocated blocks are never needed
+void initialise_sampler_bank(sampler_bank& bank, uint64_t seed) {
+  bank.seed=seed;
+  bank.geometry=choose_sketch_geometry(bank.num_cols,bank.num_rows,bank.j);
+  size_t block_counters=(size_t)bank.samplers_per_l0*((bank.fingerprint_base!=0) ? 3 : 2)*bank.j*bank.num_cols*bank.num_rows;
+  initialise_counter_pool(bank.pool,POOL_BLOCKS_PER_CHUNK*block_counters);
+  bank.reservoir_capacity=(RESERVOIR_CAPACITY<0) ? block_counters*sizeof(long)/sizeof(vertex) : RESERVOIR_CAPACITY; // -1: as many as fit in the space of its counters
+  BYTES+=sizeof(sampler_bank);
+}
+
+// allocate counters & hashes for the samplers_per_l0 samplers of a sampled vertex on its first update (or when its reservoir is replaced)
+map<vertex,int>::iterator add_sampler_block(sampler_bank& bank, vertex target) {
+  int samplers_per_l0=bank.samplers_per_l0, j=bank.j, num_cols=bank.num_cols, num_rows=bank.num_rows;
+  map<vertex,int>::iterator it=bank.sample_blocks.insert(make_pair(target,0)).first;
+  it->second=bank.block_vertices.size();
+  bank.block_vertices.push_back(target);
+  BYTES+=2*sizeof(vertex)+sizeof(int)+sizeof(void*);
+  if (BATCH_SIZE>0) BYTES+=sizeof(int); // bucket of block
+
+  for (int i=0; i<samplers_per_l0; i++) {
+    bank.phi_s.push_back(pool_zero_3d_array(bank.pool,j,num_cols,num_rows)); // sum of weights (sum ai)
+    bank.iota_s.push_back(pool_zero_3d_array(bank.pool,j,num_cols,num_rows)); // weighted sum of weights (sum ai*i)
+    if (bank.fingerprint_base!=0) bank.tau_s.push_back(pool_zero_3d_array(bank.pool,j,num_cols,num_rows)); // sum ai*z^i mod FINGERPRINT_P
+    bank.sparsity_estimates.push_back(0);
+  }
+
+  // generate hash of each sampler, replaces unique hash map & s-sparse hashes
+  static thread_local mt19937_64 generator(chrono::system_clock::now().time_since_epoch().count()^hash<thread::id>()(this_thread::get_id())); // seed with current time & thread
+  time_point before=chrono::high_resolution_clock::now(); // time before execution
+  for (int i=0; i<samplers_per_l0; i++) bank.ps_s.push_back(generate_sampler_hash(generator));
+  time_point after=chrono::high_resolution_clock::now(); // time after execution
+  GENERATING_L0_HASH_TIME+=chrono::duration_cast<chrono::microseconds>(after-before).count();
+
+  BYTES+=samplers_per_l0*((bank.fingerprint_base!=0) ? 3 : 2)*(sizeof(long***)+j*(sizeof(long**)+num_cols*sizeof(long*))); // counter values are accounted for by the pool
+  BYTES+=samplers_per_l0*(sizeof(sampler_hash)+sizeof(int));
+  L0_HASH_BYTES+=samplers_per_l0*sizeof(sampler_hash);
+  return it;
+}
+
+// empty reservoir for a sampled vertex on its first update
+map<vertex,int>::iterator add_reservoir(sampler_bank& bank, vertex target) {
+  map<vertex,int>::iterator it=bank.sample_blocks.insert(make_pair(target,-(int)bank.reservoirs.size()-1)).first;
+  bank.reservoirs.push_back(vector<vertex>()); bank.reservoir_vertices.push_back(target);
+  BYTES+=2*sizeof(vertex)+sizeof(int)+sizeof(void*)+sizeof(vector<vertex>);
+  return it;
+}
+
+// add an update of target's neighbourhood to its reservoir or block, false if target is not sampled
+bool ingest_update(sampler_bank& bank, update_buffer& buffer, vertex_sampling& sampling, vertex target, vertex v, int value) {
+  uint64_t lo, hi;
+  map<vertex,int>::iterator it=bank.sample_blocks.find(target);
+  if (it==bank.sample_blocks.end()) {
+    if (!is_sampled(sampling,target)) return false;
+    it=(bank.reservoir_capacity>0) ? add_reservoir(bank,target) : add_sampler_block(bank,target);
+  }
+
+  if (it->second<0) { // block is a reservoir
+    vector<vertex>& reservoir=bank.reservoirs[-it->second-1];
+    if (value==1 && reservoir.size()<bank.reservoir_capacity) {
+      if (reservoir.size()==reservoir.capacity()) BYTES+=max((size_t)1,reservoir.capacity())*sizeof(vertex); // growth of reservoir
+      reservoir.push_back(v);
+      return true;
+    }
+    // first deletion or reservoir full, replaying the reservoir as insertions into the new sketch block is exact as sketches are linear
+    it=add_sampler_block(bank,target);
+    for (size_t u=0; u<reservoir.size(); u++) {
+      hash_128(reservoir[u],bank.seed,lo,hi);
+      block_update up={it->second,reservoir[u],1,lo,hi,vertex_fingerprint(bank,reservoir[u])};
+      queue_block_update(bank,buffer,up);
+    }
+    vector<vertex>().swap(reservoir);
+  }
+
+  hash_128(v,bank.seed,lo,hi); // shared by every sampler of the block
+  block_update up={it->second,v,value,lo,hi,vertex_fingerprint(bank,v)};
+  queue_block_update(bank,buffer,up);
+  return true;
+}
+
+// move the blocks & reservoirs of other (a bank of the same pass over different vertices) to the end of bank
+// the counters stay in other's pool, so other is freed (with free_sampler_bank) only once bank is no longer used
+void append_sampler_bank(sampler_bank& bank, sampler_bank& other) {
+  int first_block=bank.block_vertices.size(), first_reservoir=bank.reservoirs.size();
+  for (map<vertex,int>::iterator it=other.sample_blocks.begin(); it!=other.sample_blocks.end(); it++) {
+    bank.sample_blocks[it->first]=(it->second>=0) ? it->second+first_block : it->second-first_reservoir;
+  }
+  bank.block_vertices.insert(bank.block_vertices.end(),other.block_vertices.begin(),other.block_vertices.end());
+  bank.phi_s.insert(bank.phi_s.end(),other.phi_s.begin(),other.phi_s.end());
+  bank.iota_s.insert(bank.iota_s.end(),other.iota_s.begin(),other.iota_s.end());
+  bank.tau_s.insert(bank.tau_s.end(),other.tau_s.begin(),other.tau_s.end());
+  bank.ps_s.insert(bank.ps_s.end(),other.ps_s.begin(),other.ps_s.end());
+  bank.sparsity_estimates.insert(bank.sparsity_estimates.end(),other.sparsity_estimates.begin(),other.sparsity_estimates.end());
+  for (vector<vertex>& reservoir : other.reservoirs) bank.reservoirs.push_back(move(reservoir));
+  bank.reservoir_vertices.insert(bank.reservoir_vertices.end(),other.reservoir_vertices.begin(),other.reservoir_vertices.end());
+  BYTES+=(other.block_vertices.size()+other.reservoir_vertices.size())*(2*sizeof(vertex)+sizeof(int)+sizeof(void*)); // entries of bank's map
+
+  map<vertex,int>().swap(other.sample_blocks); vector<vertex>().swap(other.block_vertices);
+  vector<long***>().swap(other.phi_s); vector<long***>().swap(other.iota_s); vector<long***>().swap(other.tau_s); vector<sampler_hash>().swap(other.ps_s); vector<int>().swap(other.sparsity_estimates);
+  vector<vector<vertex>>().swap(other.reservoirs); vector<vertex>().swap(other.reservoir_vertices);
+}
+
+// sampled vertices with a block or a reservoir
+void print_vertex_sample(sampler_bank& bank) {
+  cout<<"Vertex sample={";
+  for (vector<vertex>::iterator it=bank.block_vertices.begin(); it!=bank.block_vertices.end(); it++) cout<<*it<<",";
+  for (int r=0; r<bank.reservoirs.size(); r++) if (bank.sample_blocks[bank.reservoir_vertices[r]]<0) cout<<bank.reservoir_vertices[r]<<",";
+  cout<<"\b}"<<endl<<"Total Samplers:"<<bank.phi_s.size()<<endl;
+}
+
+void free_sampler_bank(sampler_bank& bank) {
+  for (size_t i=0; i<bank.phi_s.size(); i++) {
+    free_pool_3d_array(bank.phi_s[i]);
+    free_pool_3d_array(bank.iota_s[i]);
+  }
+  for (size_t i=0; i<bank.tau_s.size(); i++) free_pool_3d_array(bank.tau_s[i]);
+  free_counter_pool(bank.pool);
+}
+
+/*---------*
+ * UPDATES *
+ *---------*/
+
+// buffer for one thread ingesting into bank, shared iff other threads ingest into bank at the same time
+void initialise_update_buffer(update_buffer& buffer, sampler_bank& bank, bool shared) {
+  buffer.batch.reserve(BATCH_SIZE); buffer.bucketed.reserve(BATCH_SIZE);
+  buffer.pipeline=initialise_update_pipeline(bank.num_rows);
+  buffer.shared=shared;
+  buffer.scratch_phi=nullptr; buffer.scratch_iota=nullptr;
+  BYTES+=sizeof(update_buffer)+2*BATCH_SIZE*sizeof(block_update)+buffer.pipeline.depth*(sizeof(uint64_t)+bank.num_rows*sizeof(int));
+  if (shared && BATCH_SIZE>0) {
+    initialise_counter_pool(buffer.scratch_pool,(size_t)2*bank.j*bank.num_cols*bank.num_rows);
+    buffer.scratch_phi=pool_zero_3d_array(buffer.scratch_pool,bank.j,bank.num_cols,bank.num_rows);
+    buffer.scratch_iota=pool_zero_3d_array(buffer.scratch_pool,bank.j,bank.num_cols,bank.num_rows);
+    BYTES+=2*(sizeof(long***)+bank.j*(sizeof(long**)+bank.num_cols*sizeof(long*))); // counter values are accounted for by the pool
+  }
+}
+
+void free_update_buffer(update_buffer& buffer) {
+  free_update_pipeline(buffer.pipeline);
+  if (buffer.scratch_phi==nullptr) return;
+  free_pool_3d_array(buffer.scratch_phi);
+  free_pool_3d_array(buffer.scratch_iota);
+  free_counter_pool(buffer.scratch_pool);
+}
+
+// apply an update to its block as it arrives, or add it to the batch & apply the batch once full
+void queue_block_update(sampler_bank& bank, update_buffer& buffer, block_update& up) {
+  if (BATCH_SIZE==0) {
+    update_block(bank,buffer,up);
+    return;
+  }
+  buffer.batch.push_back(up);
+  if (buffer.batch.size()==BATCH_SIZE) apply_update_batch(bank,buffer);
+}
+
+// radix partition the batch by block (block ids are dense so a single counting pass), then apply each bucket sampler by sampler
+// so the counters of a sampler stay in L1 while every update of the bucket is applied to them
+// shared: the bucket is summed in the scratch sampler which is then added to the bank's sampler
+void apply_update_batch(sampler_bank& bank, update_buffer& buffer) {
+  vector<block_update>& batch=buffer.batch; vector<block_update>& bucketed=buffer.bucketed; vector<int>& bucket_ends=buffer.bucket_ends;
+  if (batch.empty()) return;
+  int num_blocks=bank.block_vertices.size(), samplers_per_l0=bank.samplers_per_l0, j=bank.j, num_cols=bank.num_cols, num_rows=bank.num_rows;
+  vector<long***>& phi_s=bank.phi_s; vector<long***>& iota_s=bank.iota_s; vector<sampler_hash>& ps_s=bank.ps_s; vector<int>& sparsity_estimates=bank.sparsity_estimates;
+  bool shared=buffer.shared;
+  bucket_ends.assign(num_blocks+1,0);
+  for (block_update& u : batch) bucket_ends[u.block+1]++;
+  for (int b=0; b<num_blocks; b++) bucket_ends[b+1]+=bucket_ends[b]; // bucket_ends[b]=start of bucket b
+  bucketed.resize(batch.size());
+  for (block_update& u : batch) bucketed[bucket_ends[u.block]++]=u; // bucket_ends[b] ends up as end of bucket b
+
+  int start=0;
+  for (int b=0; b<num_blocks; b++) {
+    int end=bucket_ends[b];
+    if (start==end) continue;
+    int net_value=0, max_levels=0; // levels are nested so only the first max_levels levels of the scratch are touched
+    for (int u=start; u<end; u++) net_value+=bucketed[u].value;
+    int* cols=buffer.pipeline.cols;
+    int prefetch_cells=min(2,j)*num_cols*num_rows; // levels 0 & 1 take 3/4 of updates
+    for (int i=b*samplers_per_l0; i<(b+1)*samplers_per_l0; i++) {
+      if (PREFETCH_DISTANCE>0) {
+        prefetch_tables(phi_s,iota_s,i+2*PREFETCH_DISTANCE,(b+1)*samplers_per_l0);
+        if (i+PREFETCH_DISTANCE<(b+1)*samplers_per_l0) prefetch_sampler(phi_s[i+PREFETCH_DISTANCE],iota_s[i+PREFETCH_DISTANCE],prefetch_cells);
+      }
+      long*** phi=(shared) ? buffer.scratch_phi : phi_s[i]; long*** iota=(shared) ? buffer.scratch_iota : iota_s[i];
+      if (shared) __atomic_fetch_add(&sparsity_estimates[i],net_value,__ATOMIC_RELAXED);
+      else sparsity_estimates[i]+=net_value;
+      max_levels=0;
+      for (int u=start; u<end; u++) {
+        block_update& up=bucketed[u];
+        uint64_t h=sampler_unique_hash(up.lo,up.hi,ps_s[i]);
+        sampler_cols(up.lo,up.hi,ps_s[i],num_rows,num_cols,cols);
+        bank.geometry.update(up.v,up.value,h,cols,j,num_cols,num_rows,phi,iota);
+        if (bank.fingerprint_base!=0) update_fingerprints(up.value,up.fp,h,cols,j,num_cols,num_rows,bank.tau_s[i],shared); // not summed in the scratch, tau is mod FINGERPRINT_P
+        if (!shared) continue;
+        int levels=(h==0) ? j : min(j,__builtin_clzll(h)); // level k keeps h iff top k+1 bits are 0
+        if (levels>max_levels) max_levels=levels;
+      }
+      if (shared) flush_scratch(max_levels*num_cols*num_rows,buffer.scratch_phi,buffer.scratch_iota,phi_s[i],iota_s[i]);
+    }
+    start=end;
+  }
+  batch.clear();
+}
+
+// apply an update to every sampler of its block, the hashes of sampler i+PREFETCH_DISTANCE are computed & its cells prefetched while sampler i is updated
+void update_block(sampler_bank& bank, update_buffer& buffer, block_update& up) {
+  int samplers_per_l0=bank.samplers_per_l0, j=bank.j, num_cols=bank.num_cols, num_rows=bank.num_rows;
+  vector<long***>& phi_s=bank.phi_s; vector<long***>& iota_s=bank.iota_s; vector<sampler_hash>& ps_s=bank.ps_s; vector<int>& sparsity_estimates=bank.sparsity_estimates;
+  update_pipeline& pipeline=buffer.pipeline;
+  int first=up.block*samplers_per_l0, last=(up.block+1)*samplers_per_l0;
+  for (int i=first; i<last+PREFETCH_DISTANCE; i++) {
+    if (PREFETCH_DISTANCE>0) prefetch_tables(phi_s,iota_s,i+PREFETCH_DISTANCE,last);
+    if (i<last) { // compute hashes of sampler i & prefetch its cells
+      int slot=(i-first)%pipeline.depth;
+      pipeline.h[slot]=sampler_unique_hash(up.lo,up.hi,ps_s[i]);
+      sampler_cols(up.lo,up.hi,ps_s[i],num_rows,num_cols,pipeline.cols+slot*num_rows);
+      if (PREFETCH_DISTANCE>0) prefetch_levels(pipeline.h[slot],pipeline.cols+slot*num_rows,j,num_cols,num_rows,phi_s[i],iota_s[i]);
+    }
+    int k=i-PREFETCH_DISTANCE; // sampler whose cells were prefetched PREFETCH_DISTANCE samplers ago
+    if (k<first) continue;
+    int slot=(k-first)%pipeline.depth;
+    if (buffer.shared) {
+      __atomic_fetch_add(&sparsity_estimates[k],up.value,__ATOMIC_RELAXED);
+      bank.geometry.update_atomic(up.v,up.value,pipeline.h[slot],pipeline.cols+slot*num_rows,j,num_cols,num_rows,phi_s[k],iota_s[k]);
+    } else {
+      sparsity_estimates[k]+=up.value;
+      bank.geometry.update(up.v,up.value,pipeline.h[slot],pipeline.cols+slot*num_rows,j,num_cols,num_rows,phi_s[k],iota_s[k]);
+    }
+    if (bank.fingerprint_base!=0) update_fingerprints(up.value,up.fp,pipeline.h[slot],pipeline.cols+slot*num_rows,j,num_cols,num_rows,bank.tau_s[k],buffer.shared);
+  }
+}
+
+// add the first num_cells counters of a scratch sampler to a shared sampler & zero them, one atomic add per non zero counter
+void flush_scratch(int num_cells, long*** scratch_phi, long*** scratch_iota, long*** phi, long*** iota) {
+  long* scratch_phi_0=scratch_phi[0][0]; long* scratch_iota_0=scratch_iota[0][0];
+  long* phi_0=phi[0][0]; long* iota_0=iota[0][0];
+  for (int cell=0; cell<num_cells; cell++) {
+    if (scratch_phi_0[cell]!=0) {
+      __atomic_fetch_add(phi_0+cell,scratch_phi_0[cell],__ATOMIC_RELAXED);
+      scratch_phi_0[cell]=0;
+    }
+    if (scratch_iota_0[cell]!=0) {
+      __atomic_fetch_add(iota_0+cell,scratch_iota_0[cell],__ATOMIC_RELAXED);
+      scratch_iota_0[cell]=0;
+    }
+  }
+}
+
+/*----------*
+ * RECOVERY *
+ *----------*/
+
+// first sampled vertex with >= threshold recovered neighbours, blocks (& live reservoirs) are tried from highest degree & those of degree < threshold are never decoded
+// a live reservoir is decoded as the block it would become, its neighbours are replayed into a temporary block with fresh sampler hashes
+// (as add_sampler_block would draw), so it answers with the L0 samples of its neighbourhood a sketch would give rather than all of it
+// difference: bank is the difference of two banks of one pass (see subtract_sketch), so its cells are signed
+bool find_neighbourhood(sampler_bank& bank, int threshold, int num_vertices, bool difference, bool verbose, set<vertex>& neighbourhood, vertex& root) {
+  int samplers_per_l0=bank.samplers_per_l0, j=bank.j, num_cols=bank.num_cols, num_rows=bank.num_rows;
+  vector<long***>& phi_s=bank.phi_s; vector<long***>& iota_s=bank.iota_s; vector<sampler_hash>& ps_s=bank.ps_s; vector<int>& sparsity_estimates=bank.sparsity_estimates;
+
+  vector<int> reservoir_order; // live reservoirs of size >= threshold, largest first
+  for (int r=0; r<bank.reservoirs.size(); r++) {
+    if (bank.sample_blocks[bank.reservoir_vertices[r]]>=0) continue; // became a sketch block
+    if (bank.reservoirs[r].size()>=threshold) reservoir_order.push_back(r);
+  }
+  stable_sort(reservoir_order.begin(),reservoir_order.end(),[&](int x, int y) {return bank.reservoirs[x].size()>bank.reservoirs[y].size();});
+  if (!reservoir_order.empty()) {
+    counter_pool pool; initialise_counter_pool(pool,(size_t)2*j*num_cols*num_rows);
+    long*** phi=pool_zero_3d_array(pool,j,num_cols,num_rows); long*** iota=pool_zero_3d_array(pool,j,num_cols,num_rows); // temporary sampler
+    static thread_local mt19937_64 generator(chrono::system_clock::now().time_since_epoch().count()^hash<thread::id>()(this_thread::get_id())); // seed with current time & thread
+    int cols[num_rows]; uint64_t lo, hi;
+    bool found=false;
+    for (int b=0; b<reservoir_order.size() && !found; b++) {
+      vector<vertex>& reservoir=bank.reservoirs[reservoir_order[b]]; neighbourhood.clear();
+      for (int i=0; i<samplers_per_l0 && !found; i++) {
+        sampler_hash ps=generate_sampler_hash(generator);
+        memset(phi[0][0],0,(size_t)j*num_cols*num_rows*sizeof(long)); memset(iota[0][0],0,(size_t)j*num_cols*num_rows*sizeof(long));
+        for (size_t u=0; u<reservoir.size(); u++) { // a reservoir only holds insertions, so its temporary block is never signed
+          hash_128(reservoir[u],bank.seed,lo,hi);
+          sampler_cols(lo,hi,ps,num_rows,num_cols,cols);
+          bank.geometry.update(reservoir[u],1,sampler_unique_hash(lo,hi,ps),cols,j,num_cols,num_rows,phi,iota);
+        }
+        set<vertex> sampled_neighbourhood=decode_sampler(bank,num_vertices,false,phi,iota,nullptr,ps,reservoir.size());
+        neighbourhood.insert(sampled_neighbourhood.begin(),sampled_neighbourhood.end());
+        found=(neighbourhood.size()>=threshold);
+      }
+      if (found) root=bank.reservoir_vertices[reservoir_order[b]];
+    }
+    free_pool_3d_array(phi); free_pool_3d_array(iota);
+    free_counter_pool(pool);
+    if (found) {
+      if (verbose) {
+        cout<<endl<<"SUCCESSES ("<<neighbourhood.size()<<")"<<endl;
+        cout<<"NEIGHBOURHOOD for "<<root<<"={";
+        for (set<vertex>::iterator it=neighbourhood.begin(); it!=neighbourhood.end(); it++) cout<<*it<<",";
+        cout<<"\b}"<<endl;
+      }
+      return true;
+    }
+  }
+
+  vector<int> recovery_order=plan_recovery(bank.block_vertices.size(),samplers_per_l0,threshold,sparsity_estimates);
+  if (verbose) cout<<"Blocks to recover:"<<recovery_order.size()<<"/"<<bank.block_vertices.size()<<endl;
+  for (int b=0; b<recovery_order.size(); b++) {
+    vertex target=bank.block_vertices[recovery_order[b]]; neighbourhood.clear(); // restart neighbourhood for each sampled vertex
+    if (verbose) cout<<"\r"<<target<<"                                       "<<endl;
+    for (int i=recovery_order[b]*samplers_per_l0; i<(recovery_order[b]+1)*samplers_per_l0; i++) {
+      if (sparsity_estimates[i]<2) continue;
+      long*** tau=(difference && bank.fingerprint_base!=0) ? bank.tau_s[i] : nullptr; // only signed cells need the fingerprint
+      if (verbose && !HARVEST_LEVELS) cout<<"\r"<<i<<"/"<<phi_s.size()<<"                                     ";
+      set<vertex> sampled_neighbourhood=decode_sampler(bank,num_vertices,difference,phi_s[i],iota_s[i],tau,ps_s[i],sparsity_estimates[i]);
+      neighbourhood.insert(sampled_neighbourhood.begin(),sampled_neighbourhood.end());
+      if (neighbourhood.size()>=threshold) {
+        root=target;
+        if (verbose) {
+          cout<<endl<<"SUCCESSES ("<<neighbourhood.size()<<")"<<endl;
+          cout<<"NEIGHBOURHOOD for "<<target<<"={";
+          for (set<vertex>::iterator it=neighbourhood.begin(); it!=neighbourhood.end(); it++) cout<<*it<<",";
+          cout<<"\b}"<<endl;
+        }
+        return true;
+      }
+    }
+  }
+  neighbourhood.clear();
+  return false;
+}
+
+// neighbours one sampler gives: every decoded neighbour if HARVEST_LEVELS, else the min hash neighbour of the level chosen by the sparsity estimate (if any)
+set<vertex> decode_sampler(sampler_bank& bank, int num_vertices, bool difference, long*** phi, long*** iota, long*** tau, sampler_hash& ps, int sparsity_estimate) {
+  int s=bank.s, j=bank.j, num_cols=bank.num_cols, num_rows=bank.num_rows;
+  if (HARVEST_LEVELS) return harvest_neighbours(j,num_cols,num_rows,s,num_vertices,bank.seed,ps,bank.geometry.recover,difference,phi,iota,tau,bank.fingerprint_base);
+
+  set<vertex> sampled_neighbourhood;
+  int j_sample=log2(sparsity_estimate)-1; // -1 since 0 indexed
+  if (j_sample>=j) j_sample=j-1; // degree bound exceeded, use overflow level
+  if (USE_IBLT) {
+    bool complete;
+    sampled_neighbourhood=peel_iblt(num_cols,num_rows,bank.seed,ps,phi[j_sample],iota[j_sample],(tau) ? tau[j_sample] : nullptr,bank.fingerprint_base,complete);
+    if (!complete) sampled_neighbourhood.clear(); // min hash of a partial recovery is not uniform
+  } else {
+    sampled_neighbourhood=bank.geometry.recover(num_cols,num_rows,phi[j_sample],iota[j_sample]);
+    if (difference) sampled_neighbourhood=keep_hashed_to_cells(sampled_neighbourhood,j_sample,num_cols,num_rows,bank.seed,ps,phi[j_sample],iota[j_sample],(tau) ? tau[j_sample] : nullptr,bank.fingerprint_base);
+  }
+  vertex sampled_vertex=recover_vertex(sampled_neighbourhood,s,bank.seed,ps);
+  sampled_neighbourhood.clear();
+  if (sampled_vertex!=-1) sampled_neighbourhood.insert(sampled_vertex);
+  return sampled_neighbourhood;
+}
+
+// blocks in the order they are recovered, every sampler of a block has the block's degree as its sparsity estimate (exact for a valid stream)
+// so blocks of degree < threshold cannot give threshold distinct neighbours & are dropped, the rest are in descending degree
+vector<int> plan_recovery(int num_blocks, int samplers_per_l0, int threshold, vector<int>& sparsity_estimates) {
+  vector<int> order;
+  for (int b=0; b<num_blocks; b++) if (sparsity_estimates[b*samplers_per_l0]>=threshold) order.push_back(b);
+  stable_sort(order.begin(),order.end(),[&](int x, int y) {return sparsity_estimates[x*samplers_per_l0]>sparsity_estimates[y*samplers_per_l0];});
+  return order;
+}
+
+
+/*-------------------*
+ * s-SPARSE RECOVERY *
+ *-------------------*/
+
+// choose hash function for each row of s-sparse recovery
+hash_params* choose_hash_functions(int num_cols, int num_rows) {
+  hash_params* ps_s=new hash_params[num_rows];
+  for (int i=0; i<num_rows; i++) ps_s[i]=generate_hash(num_cols);
+  return ps_s;
+}
+
+// union of the neighbours of every level which decodes (<=sparsity 1-sparse cells), all of which are neighbours of the target
+// tau_s: fingerprints of a difference sketch, which every neighbour of a signed cell must match, nullptr if the bank keeps none
+set<vertex> harvest_neighbours(int num_levels, int num_cols, int num_rows, int sparsity, int num_vertices, uint64_t seed, sampler_hash ps, neighbourhood_recoverer recover, bool difference, long*** phi_s, long*** iota_s, long*** tau_s, uint64_t z) {
+  set<vertex> harvested, level_neighbourhood;
+  bool complete;
+  for (int k=0; k<num_levels; k++) {
+    if (USE_IBLT) level_neighbourhood=peel_iblt(num_cols,num_rows,seed,ps,phi_s[k],iota_s[k],(tau_s) ? tau_s[k] : nullptr,z,complete); // every peeled vertex is a neighbour, even if peeling did not complete
+    else level_neighbourhood=recover(num_cols,num_rows,phi_s[k],iota_s[k]);
+    if (!USE_IBLT && level_neighbourhood.size()>sparsity) continue; // s-sparse recovery failed for level
+    if (!USE_IBLT && difference) level_neighbourhood=keep_hashed_to_cells(level_neighbourhood,k,num_cols,num_rows,seed,ps,phi_s[k],iota_s[k],(tau_s) ? tau_s[k] : nullptr,z);
+    for (set<vertex>::iterator it=level_neighbourhood.begin(); it!=level_neighbourhood.end(); it++) {
+      if (*it>=1 && *it<=num_vertices) harvested.insert(*it); // ignore ids which cannot be vertices
+    }
+  }
+  return harvested;
+}
+
+// update each level which keeps v, levels are nested so stop at first level which does not
+// counters of a sampler are contiguous ([level][col][row], see pool_zero_3d_array) so cells are found from the first counter
+// without loading the pointer table of each level, with ROWS fixed the row loop is unrolled
+template<int ROWS, int LEVELS, bool ATOMIC> void update_levels(vertex v, int edge_value, uint64_t h, int* cols, int num_levels, int num_cols, int num_rows, long*** phi, long*** iota) {
+  const int levels=(LEVELS>0) ? LEVELS : num_levels;
+  const int rows=(ROWS>0) ? ROWS : num_rows;
+  long* phi_k=phi[0][0]; long* iota_k=iota[0][0];
+  for (int k=0; k<levels; k++, phi_k+=num_cols*rows, iota_k+=num_cols*rows) {
+    if (h>>(63-k)) break; // level k keeps h<2^(63-k)
+    for (int r=0; r<rows; r++) {
+      if (ATOMIC) {
+        __atomic_fetch_add(phi_k+cols[r]*rows+r,edge_value,__ATOMIC_RELAXED);
+        __atomic_fetch_add(iota_k+cols[r]*rows+r,(long)edge_value*v,__ATOMIC_RELAXED);
+      } else {
+        phi_k[cols[r]*rows+r]+=edge_value;
+        iota_k[cols[r]*rows+r]+=edge_value*v;
+      }
+    }
+  }
+}
+
+// recover neighbourhood from s-sparse recovery counters, cells of a level are contiguous so the scan is a single loop
+template<int COLS, int ROWS> set<vertex> recover_neighbourhood(int num_cols, int num_rows, long** phi_s, long** iota_s) {
+  const int cells=((COLS>0) ? COLS : num_cols)*((ROWS>0) ? ROWS : num_rows);
+  long* phi=phi_s[0]; long* iota=iota_s[0];
+  set<vertex> neighbourhood;
+  for (int i=0; i<cells; i++) {
+    if (verify_1_sparse(phi[i],iota[i])) neighbourhood.insert(iota[i]);
+  }
+  return neighbourhood;
+}
+
+// geometries which are instantiated at compile time, s-sparse (delta=0.2, gamma=0.3) & IBLT (s=5) with 8-16 levels
+#define GEOMETRY(COLS,ROWS,LEVELS) {COLS,ROWS,LEVELS,update_levels<ROWS,LEVELS,false>,update_levels<ROWS,LEVELS,true>,recover_neighbourhood<COLS,ROWS>}
+sketch_geometry SKETCH_GEOMETRIES[]={
+  GEOMETRY(10,2,8), GEOMETRY(10,2,9), GEOMETRY(10,2,10), GEOMETRY(10,2,11), GEOMETRY(10,2,12),
+  GEOMETRY(10,2,13), GEOMETRY(10,2,14), GEOMETRY(10,2,15), GEOMETRY(10,2,16),
+  GEOMETRY(3,3,8), GEOMETRY(3,3,9), GEOMETRY(3,3,10), GEOMETRY(3,3,11), GEOMETRY(3,3,12),
+  GEOMETRY(3,3,13), GEOMETRY(3,3,14), GEOMETRY(3,3,15), GEOMETRY(3,3,16)
+};
+
+// instantiation for the geometry of this run, or the runtime sized version if it was not instantiated
+sketch_geometry choose_sketch_geometry(int num_cols, int num_rows, int num_levels) {
+  for (sketch_geometry& g : SKETCH_GEOMETRIES) {
+    if (g.num_cols==num_cols && g.num_rows==num_rows && g.num_levels==num_levels) return g;
+  }
+  sketch_geometry dynamic={num_cols,num_rows,num_levels,update_levels<0,0,false>,update_levels<0,0,true>,recover_neighbourhood<0,0>};
+  return dynamic;
+}
+
+// drop recovered vertices which the sampler would not have kept in a 1-sparse cell of this level
+// counters of a difference sketch are signed so phi=1 may be several inserted & deleted neighbours (eg. +a +b -c) rather than one,
+// with tau_s a cell must also match the fingerprint of its vertex, which such a mix does with probability <= iota/FINGERPRINT_P
+set<vertex> keep_hashed_to_cells(set<vertex> candidates, int level, int num_cols, int num_rows, uint64_t seed, sampler_hash ps, long** phi_s, long** iota_s, long** tau_s, uint64_t z) {
+  set<vertex> kept;
+  vector<int> cols(num_rows); uint64_t lo, hi;
+  for (set<vertex>::iterator it=candidates.begin(); it!=candidates.end(); it++) {
+    hash_128(*it,seed,lo,hi);
+    if (sampler_unique_hash(lo,hi,ps)>>(63-level)) continue; // level does not keep vertex
+    sampler_cols(lo,hi,ps,num_rows,num_cols,cols.data());
+    for (int r=0; r<num_rows; r++) {
+      if (phi_s[cols[r]][r]!=1 || iota_s[cols[r]][r]!=*it) continue;
+      if (tau_s!=nullptr && !verify_fingerprint(phi_s[cols[r]][r],iota_s[cols[r]][r],tau_s[cols[r]][r],z)) continue;
+      kept.insert(*it); break;
+    }
+  }
+  return kept;
+}
+
+// recover vertex from recovered neighbourhood
+vertex recover_vertex(set<vertex> neighbourhood, int sparsity, uint64_t seed, sampler_hash ps) {
+  if (neighbourhood.size()>sparsity || neighbourhood.size()==0) return -1; // s-sparse recovery failed
+  else { // return vertex in neighbourhood with min hash value
+    uint64_t min_hash=UINT64_MAX, min_val=-1, lo, hi;
+    for (set<vertex>::iterator it=neighbourhood.begin(); it!=neighbourhood.end(); it++) {
+      hash_128(*it,seed,lo,hi);
+      uint64_t h_i=sampler_unique_hash(lo,hi,ps);
+      if (h_i<min_hash) { // lowest yet
+        min_hash=h_i;
+        min_val=*it;
+      }
+    }
+    return min_val;
+  }
+}
+
+/*------*
+ * IBLT *
+ *------*/
+
+// IBLT_ROWS rows (each with its own hash) with enough cols for IBLT_CELLS*s cells in total
+void iblt_geometry(int s, int& num_cols, int& num_rows) {
+  num_rows=IBLT_ROWS;
+  num_cols=ceil(IBLT_CELLS*s/IBLT_ROWS);
+  if (num_cols<2) num_cols=2; // a single col puts every vertex in the same cells
+}
+
+// recover neighbours by peeling pure cells, removing each recovered vertex from its other cells
+// complete=true iff every cell is empty afterwards, the counters are copied so the IBLT is unchanged
+// tau_s: fingerprints of a difference sketch (see keep_hashed_to_cells) which a pure cell must match, nullptr if the bank keeps none
+set<vertex> peel_iblt(int num_cols, int num_rows, uint64_t seed, sampler_hash ps, long** phi_s, long** iota_s, long** tau_s, uint64_t z, bool& complete) {
+  vector<long> phi(num_cols*num_rows), iota(num_cols*num_rows), tau(num_cols*num_rows,0);
+  vector<int> cols(num_rows); uint64_t lo, hi;
+  deque<int> pure; // indices of cells which may be pure
+  for (int c=0; c<num_cols; c++) {
+    for (int r=0; r<num_rows; r++) {
+      int i=c*num_rows+r;
+      phi[i]=phi_s[c][r]; iota[i]=iota_s[c][r];
+      if (tau_s!=nullptr) tau[i]=tau_s[c][r];
+      if (phi[i]!=0) pure.push_back(i);
+  }}
+
+  set<vertex> neighbourhood;
+  while (!pure.empty()) {
+    int i=pure.front(); pure.pop_front();
+    if (!verify_1_sparse(phi[i],iota[i])) continue;
+    if (tau_s!=nullptr && !verify_fingerprint(phi[i],iota[i],tau[i],z)) continue;
+    vertex v=iota[i];
+    hash_128(v,seed,lo,hi);
+    sampler_cols(lo,hi,ps,num_rows,num_cols,cols.data());
+    if (cols[i%num_rows]!=i/num_rows) continue; // v does not belong in this cell so cell is not pure
+
+    neighbourhood.insert(v);
+    for (int r=0; r<num_rows; r++) { // remove v from each of its cells
+      int k=cols[r]*num_rows+r;
+      phi[k]-=1; iota[k]-=v;
+      if (tau_s!=nullptr) tau[k]=fingerprint_add(tau[k],FINGERPRINT_P-fingerprint_power(z,v));
+      if (phi[k]!=0) pure.push_back(k);
+    }
+  }
+
+  complete=true;
+  for (int i=0; i<num_cols*num_rows && complete; i++) if (phi[i]!=0 || iota[i]!=0 || tau[i]!=0) complete=false;
+  return neighbourhood;
+}
+
+/*-------------------*
+ * 1-SPARSE RECOVERY *
+ *-------------------*/
+
+// verify if array is 1_sparse
+bool verify_1_sparse(int phi,int iota) {
+  if (phi==1) return true;
+  return false;
+}
+
+// a+b mod FINGERPRINT_P, for a<FINGERPRINT_P & b<=FINGERPRINT_P
+uint64_t fingerprint_add(uint64_t a, uint64_t b) {
+  uint64_t sum=a+b;
+  return (sum>=FINGERPRINT_P) ? sum-FINGERPRINT_P : sum;
+}
+
+uint64_t fingerprint_multiply(uint64_t a, uint64_t b) {
+  unsigned __int128 product=(unsigned __int128)a*b;
+  return fingerprint_add((uint64_t)(product&FINGERPRINT_P),(uint64_t)(product>>61)); // 2^61=1 mod FINGERPRINT_P
+}
+
+// z^e mod FINGERPRINT_P by squaring
+uint64_t fingerprint_power(uint64_t z, uint64_t e) {
+  uint64_t result=1;
+  for (; e>0; e>>=1, z=fingerprint_multiply(z,z)) if (e&1) result=fingerprint_multiply(result,z);
+  return result;
+}
+
+// fingerprint of a neighbour, computed once per update of a block, 0 if the bank keeps no fingerprints
+uint64_t vertex_fingerprint(sampler_bank& bank, vertex v) {
+  return (bank.fingerprint_base!=0) ? fingerprint_power(bank.fingerprint_base,v) : 0;
+}
+
+// add edge_value*fp to tau of each cell update_levels adds the neighbour to, atomic: with a compare & swap per cell as other threads add to tau
+void update_fingerprints(int edge_value, uint64_t fp, uint64_t h, int* cols, int num_levels, int num_cols, int num_rows, long*** tau, bool atomic) {
+  uint64_t delta=fingerprint_multiply(fp,abs(edge_value));
+  if (edge_value<0) delta=FINGERPRINT_P-delta;
+  long* tau_k=tau[0][0];
+  for (int k=0; k<num_levels; k++, tau_k+=num_cols*num_rows) {
+    if (h>>(63-k)) break; // level k keeps h<2^(63-k)
+    for (int r=0; r<num_rows; r++) {
+      long* cell=tau_k+cols[r]*num_rows+r;
+      if (!atomic) {
+        *cell=fingerprint_add(*cell,delta);
+        continue;
+      }
+      long old=__atomic_load_n(cell,__ATOMIC_RELAXED);
+      while (!__atomic_compare_exchange_n(cell,&old,(long)fingerprint_add(old,delta),true,__ATOMIC_RELAXED,__ATOMIC_RELAXED));
+    }
+  }
+}
+
+// cell with phi=1 is 1-sparse iff its fingerprint is that of its iota
+bool verify_fingerprint(long phi, long iota, long tau, uint64_t z) {
+  if (phi!=1 || iota<0 || iota>INT_MAX) return false; // iota of a 1-sparse cell is a vertex
+  return (uint64_t)tau==fingerprint_power(z,iota);
+}
+
+/*---------*
+ * HASHING *
+ *---------*/
+
+// generate parameters to use in hash function
+hash_params generate_hash(int m) {
+  default_random_engine generator;
+  generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+  uniform_int_distribution<unsigned long> distribution(0,P-1);
+  hash_params ps={
+    distribution(generator),
+    distribution(generator),
+    (unsigned long)m
+  };
+  return ps;
+}
+
+// hash a key
+int hash_function(int key, hash_params ps) {
+  return ((ps.a*key+ps.b)%P)%ps.m;
+}
+
+// generate parameters of hash used to choose the vertex sample, each vertex is sampled with probability sample_rate
+hash_params generate_sample_hash(double sample_rate) {
+  hash_params ps=generate_hash(P);
+  ps.m=sample_rate*P;
+  return ps;
+}
+
+// vertex is in the sample iff its hash falls below the threshold
+bool in_vertex_sample(vertex v, hash_params ps) {
+  return (ps.a*v+ps.b)%P<ps.m;
+}
+
+// splitmix64 finaliser
+inline uint64_t mix_64(uint64_t x) {
+  x+=0x9e3779b97f4a7c15ULL;
+  x=(x^(x>>30))*0xbf58476d1ce4e5b9ULL;
+  x=(x^(x>>27))*0x94d049bb133111ebULL;
+  return x^(x>>31);
+}
+
+// 128-bit hash of a neighbour (or any 64 bit key), computed once per update of a block
+inline void hash_128(uint64_t x, uint64_t seed, uint64_t& lo, uint64_t& hi) {
+  lo=mix_64(seed^x);
+  hi=mix_64(lo^(seed<<32|seed>>32));
+}
+
+// random parameters for one sampler, multipliers are odd
+sampler_hash generate_sampler_hash(mt19937_64& generator) {
+  sampler_hash ps={generator()|1,generator()|1,generator(),generator()|1,generator()|1,generator()};
+  return ps;
+}
+
+// top 64 bits of a_lo*lo+a_hi*hi+b*2^64 (vector multiply-shift)
+uint64_t multiply_shift(uint64_t lo, uint64_t hi, uint64_t a_lo, uint64_t a_hi, uint64_t b) {
+  unsigned __int128 x=(unsigned __int128)a_lo*lo+(unsigned __int128)a_hi*hi+((unsigned __int128)b<<64);
+  return x>>64;
+}
+
+// unique hash of a neighbour for a sampler, 64 bits so ties (which the unique hash maps avoided) are negligible
+uint64_t sampler_unique_hash(uint64_t lo, uint64_t hi, sampler_hash& ps) {
+  return multiply_shift(lo,hi,ps.a_lo,ps.a_hi,ps.a_b);
+}
+
+// col of each row for a sampler, taken from 16 bit fields of the col hash (remixed every 4 rows)
+inline void sampler_cols(uint64_t lo, uint64_t hi, sampler_hash& ps, int num_rows, int num_cols, int* cols) {
+  uint64_t g=multiply_shift(lo,hi,ps.c_lo,ps.c_hi,ps.c_b);
+  for (int r=0; r<num_rows; r+=4) {
+    if (r>0) g=mix_64(g);
+    for (int f=0; f<4 && r+f<num_rows; f++) cols[r+f]=((g>>(48-16*f)&0xFFFF)*num_cols)>>16;
+  }
+}
+
+// generate random hash with unique values for all keys
+uint64_t* generate_random_hash(int n, uint64_t m) {
+  vector<uint64_t> used; // record hash values which have been used
+  uint64_t* hash_map=new uint64_t[n+1];
+  default_random_engine generator;
+  generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+  uniform_int_distribution<uint64_t> distribution(0,m);
+  for (int i=1; i<=n; i++) {
+    // find unique hash_value
+    uint64_t hash_value=distribution(generator);
+    while (find(used.begin(), used.end(), hash_value)!=used.end()) hash_value=distribution(generator);
+
+    hash_map[i]=hash_value;         // store in hash map
+    used.push_back(hash_value); // record hash_value as used
+  }
+  return hash_map;
+}
+
+
+/*-------------*
+ * PREFETCHING *
+ *-------------*/
+
+update_pipeline initialise_update_pipeline(int num_rows) {
+  update_pipeline pipeline;
+  pipeline.depth=PREFETCH_DISTANCE+1;
+  pipeline.h=new uint64_t[pipeline.depth];
+  pipeline.cols=new int[pipeline.depth*num_rows];
+  return pipeline;
+}
+
+void free_update_pipeline(update_pipeline& pipeline) {
+  delete[] pipeline.h;
+  delete[] pipeline.cols;
+}
+
+// prefetch (for writing) the cells of the levels which keep unique hash h, levels of a sampler are contiguous in the pool
+inline void prefetch_levels(uint64_t h, int* cols, int num_levels, int num_cols, int num_rows, long*** phi, long*** iota) {
+  long* phi_0=phi[0][0]; long* iota_0=iota[0][0];
+  for (int k=0; k<num_levels; k++) {
+    if (h>>(63-k)) break;
+    for (int r=0; r<num_rows; r++) {
+      int cell=(k*num_cols+cols[r])*num_rows+r;
+      __builtin_prefetch(phi_0+cell,1);
+      __builtin_prefetch(iota_0+cell,1);
+    }
+  }
+}
+
+// the first counter of a sampler is reached through 2 pointer tables, prefetch the level table of sampler i
+// & the outer table of sampler i+PREFETCH_DISTANCE so both are cached by the time the counters are prefetched
+inline void prefetch_tables(vector<long***>& phi_s, vector<long***>& iota_s, int i, int last) {
+  if (i<last) {
+    __builtin_prefetch(phi_s[i][0]);
+    __builtin_prefetch(iota_s[i][0]);
+  }
+  if (i+PREFETCH_DISTANCE<last) {
+    __builtin_prefetch(phi_s[i+PREFETCH_DISTANCE]);
+    __builtin_prefetch(iota_s[i+PREFETCH_DISTANCE]);
+  }
+}
+
+// prefetch (for writing) the first num_cells counters of a sampler, one per cache line
+inline void prefetch_sampler(long*** phi, long*** iota, int num_cells) {
+  long* phi_0=phi[0][0]; long* iota_0=iota[0][0];
+  for (int cell=0; cell<num_cells; cell+=64/sizeof(long)) {
+    __builtin_prefetch(phi_0+cell,1);
+    __builtin_prefetch(iota_0+cell,1);
+  }
+}
+
+/*--------------*
+ * COUNTER POOL *
+ *--------------*/
+
+void initialise_counter_pool(counter_pool& pool, size_t chunk_size) {
+  pool.chunks.clear();
+  pool.chunk_size=chunk_size;
+  pool.used=chunk_size; // forces a chunk to be allocated on first use
+}
+
+// return pointer to size zeroed longs, allocating a new chunk if the last is full
+long* pool_allocate(counter_pool& pool, size_t size) {
+  if (pool.used+size>pool.chunk_size) {
+    size_t chunk_size=(size>pool.chunk_size) ? size : pool.chunk_size;
+    size_t mapped_size;
+    pool.chunks.push_back(allocate_chunk(chunk_size*sizeof(long),mapped_size));
+    pool.chunk_bytes.push_back(mapped_size);
+    pool.used=0;
+    BYTES+=sizeof(long*)+sizeof(size_t)+mapped_size;
+  }
+  long* ptr=pool.chunks.back()+pool.used;
+  pool.used+=size;
+  return ptr;
+}
+
+// 3d array with values taken from the pool, arr[d][c][r] with every value of the array contiguous ([d][c][r] order)
+long*** pool_zero_3d_array(counter_pool& pool, int depth, int num_cols, int num_rows) {
+  long*** arr=(long***) malloc(depth*sizeof(long**)); // allocate depth
+  long** cols=(long**) malloc(depth*num_cols*sizeof(long*)); // allocate all cols at once
+  long* vals=pool_allocate(pool,(size_t)depth*num_cols*num_rows);
+  for (int i=0; i<depth; i++) {
+    arr[i]=cols+i*num_cols;
+    for (int j=0; j<num_cols; j++) arr[i][j]=vals+((size_t)i*num_cols+j)*num_rows;
+  }
+  return arr;
+}
+
+// free pointers of 3d array from pool, values are freed with the pool
+void free_pool_3d_array(long*** arr) {
+  free(arr[0]);
+  free(arr);
+}
+
+void free_counter_pool(counter_pool& pool) {
+  for (size_t i=0; i<pool.chunks.size(); i++) munmap(pool.chunks[i],pool.chunk_bytes[i]);
+  pool.chunks.clear();
+  pool.chunk_bytes.clear();
+}
+
+/*-------------------------*
+ * HUGE PAGES & NUMA NODES *
+ *-------------------------*/
+
+// map size bytes of zeroed memory for a pool chunk, mapped_size is the size actually mapped
+// counters are updated at random so with 4KB pages most updates miss the TLB, a 2MB page covers 512 times as much
+long* allocate_chunk(size_t size, size_t& mapped_size) {
+  if (!HUGE_PAGES) {
+    void* ptr=map_plain_chunk(size,mapped_size);
+    place_chunk(ptr,size);
+    return (long*) ptr;
+  }
+  mapped_size=(size+HUGE_PAGE_SIZE-1)/HUGE_PAGE_SIZE*HUGE_PAGE_SIZE; // whole huge pages
+  void* ptr=mmap(nullptr,mapped_size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB,-1,0); // reserved huge pages
+  if (ptr==MAP_FAILED) { // none reserved, map an extra huge page so the chunk can start on a huge page boundary
+    char* raw=(char*) mmap(nullptr,mapped_size+HUGE_PAGE_SIZE,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+    if (raw==(char*) MAP_FAILED) { // no room for the extra page either, fall back to plain pages
+      ptr=map_plain_chunk(size,mapped_size);
+      place_chunk(ptr,size);
+      return (long*) ptr;
+    }
+    char* aligned=(char*) (((uintptr_t)raw+HUGE_PAGE_SIZE-1)/HUGE_PAGE_SIZE*HUGE_PAGE_SIZE);
+    if (aligned>raw) munmap(raw,aligned-raw);
+    if (aligned+mapped_size<raw+mapped_size+HUGE_PAGE_SIZE) munmap(aligned+mapped_size,raw+HUGE_PAGE_SIZE-aligned);
+    madvise(aligned,mapped_size,MADV_HUGEPAGE); // transparent huge pages are used on first touch
+    ptr=aligned;
+  }
+  place_chunk(ptr,mapped_size);
+  return (long*) ptr;
+}
+
+// map size bytes of zeroed 4KB pages, the stream cannot continue without its counters so a failed mapping exits
+void* map_plain_chunk(size_t size, size_t& mapped_size) {
+  mapped_size=size;
+  void* ptr=mmap(nullptr,size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+  if (ptr==MAP_FAILED) {
+    cout<<"***********************************ALLOCATE CHUNK FAILURE ("<<size<<" bytes: "<<strerror(errno)<<")"<<endl;
+    exit(1);
+  }
+  return ptr;
+}
+
+// set the NUMA policy of a chunk before it is touched, policies the kernel rejects (no NUMA support) leave first touch placement
+void place_chunk(void* ptr, size_t size) {
+  if (NUMA_PLACEMENT==0) return;
+  unsigned long nodes=online_nodes();
+  if (NUMA_PLACEMENT==1) syscall(SYS_mbind,ptr,size,MPOL_INTERLEAVE,&nodes,sizeof(nodes)*8,0);
+  else { // node of the cpu the owning worker is running on, the worker allocates its own chunks
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu,&cpu,&node,nullptr)!=0 || node>=sizeof(nodes)*8) return;
+    unsigned long node_mask=1UL<<node;
+    syscall(SYS_mbind,ptr,size,MPOL_BIND,&node_mask,sizeof(node_mask)*8,0);
+  }
+}
+
+// mask of online NUMA nodes (up to 64) from ranges such as "0-1,3", node 0 if unknown
+unsigned long online_nodes() {
+  ifstream node_stream("/sys/devices/system/node/online");
+  string ranges;
+  if (!getline(node_stream,ranges)) return 1;
+  unsigned long nodes=0; int first=-1, last=0;
+  for (size_t i=0; i<=ranges.size(); i++) {
+    if (i<ranges.size() && ranges[i]>='0' && ranges[i]<='9') last=10*last+(ranges[i]-'0');
+    else if (i<ranges.size() && ranges[i]=='-') {first=last; last=0;}
+    else { // end of range
+      if (first==-1) first=last;
+      for (int node=first; node<=last && node<64; node++) nodes|=1UL<<node;
+      first=-1; last=0;
+    }
+  }
+  return (nodes==0) ? 1 : nodes;
+}
+
+// fraction of the bytes of every pool chunk which are in huge pages, taken from the mappings in /proc/self/smaps
+// reserved huge pages are reported by KernelPageSize, transparent huge pages by AnonHugePages
+double huge_page_coverage(vector<sampler_bank>& banks) {
+  struct mapping {uintptr_t start, end; size_t huge_bytes;};
+  vector<mapping> mappings;
+  ifstream smaps("/proc/self/smaps");
+  string line;
+  while (getline(smaps,line)) {
+    unsigned long start, end, kb;
+    if (sscanf(line.c_str(),"%lx-%lx ",&start,&end)==2 && line.find(':')>line.find(' ')) mappings.push_back({start,end,0});
+    else if (mappings.empty()) continue;
+    else if (sscanf(line.c_str(),"AnonHugePages: %lu kB",&kb)==1) mappings.back().huge_bytes+=kb*1024;
+    else if (sscanf(line.c_str(),"KernelPageSize: %lu kB",&kb)==1 && kb*1024>=HUGE_PAGE_SIZE) mappings.back().huge_bytes=mappings.back().end-mappings.back().start;
+  }
+
+  size_t huge_bytes=0, total_bytes=0;
+  for (sampler_bank& bank : banks) {
+    for (size_t i=0; i<bank.pool.chunks.size(); i++) {
+      uintptr_t start=(uintptr_t)bank.pool.chunks[i], end=start+bank.pool.chunk_bytes[i];
+      total_bytes+=end-start;
+      for (mapping& m : mappings) { // chunks may have been merged into one mapping, share its huge pages out by overlap
+        if (m.end<=start || m.start>=end) continue;
+        double overlap=(double) (min(end,m.end)-max(start,m.start))/(m.end-m.start);
+        huge_bytes+=overlap*m.huge_bytes;
+      }
+    }
+  }
+  return (total_bytes==0) ? 0 : min(1.0,(double)huge_bytes/total_bytes);
+}
+
+/*-----------*
+ * UTILITIES *
+ *-----------*/
+
+// parse edge from string "v1 v2" or "(I/D) v1 v2"
+void parse_edge(string str, edge& e) {
+  int spaces=count(str.begin(),str.end(),' ');
+
+  if (spaces==2) { // insertion deletion edge
+    if (str[0]=='D') e.value=-1;
+    else e.value=1;
+    str=str.substr(2,str.size());
+  } else if (spaces==1) { // insertion edge
+    e.value=1;
+  }
+
+  string fst="",snd="";
+  bool after=false;
+
+  for (char& c:str) {
+    if (c==' ') { // seperator
+      after=true;
+    } else if (after) { // second id
+      snd+=c;
+    } else { // first id
+      fst+=c;
+    }
+  }
+
+  // Update edge values
+  try {
+    e.fst=stoi(fst);
+    e.snd=stoi(snd);
+  } catch (exception ex) {
+    e.fst=-1;
+    e.snd=-1;
+    e.value=0;
+  }
+}
+
+// parse vertex from line in file
+void parse_vertex(string str, vertex& v) {
+  string vertex_name="";
+  for (char& c:str) {
+    if (c==',') break; // name done
+    vertex_name+=c;
+  }
+  v=stoi(vertex_name);
+}
+
+hash_params** initalise_2d_hash_params_array(int num_cols, int num_rows) {
+  hash_params** arr = (hash_params**) malloc(num_cols * sizeof(hash_params*)); // allocate cols
+  // allocate rows
+  for (int i=0; i<num_cols; i++) arr[i]=(hash_params*) malloc(num_rows * sizeof(hash_params));
+  return arr;
+}
+
+// return variance of values in a vector
+double variance(vector<uint64_t> vals) {
+  if (vals.size()<=1) return 0;
+  double var=0;
+  double mean=accumulate(vals.begin(),vals.end(),0)/vals.size();
+
+  for (vector<uint64_t>::iterator it=vals.begin(); it!=vals.end(); it++) var+=(*it-mean)*(*it-mean);
+  var/=(vals.size()-1);
+
+  return var;
+}
+
+uint64_t mean(vector<uint64_t> vals) {
+  if (vals.size()==0) return 0;
+  uint64_t sum=0;
+  for (vector<uint64_t>::iterator it=vals.begin(); it!=vals.end(); it++) sum+=*it;
+
+  return sum/vals.size();
+}
+
+#endif
@@ -175,21 +175,20 @@ int single_pass_insertion_stream(int c, int d, int n, ifstream& stream, vector<v
     if (edge_count%10000==0) cout<<"\r"<<edge_count;
 
     // increment degrees for each vertex
-    if (degrees.count(e.fst)) {
-      degrees[e.fst]+=1;
-    } else {
-      degrees[e.fst]=1;
+    // each degree is looked up once per edge, map references stay valid so the parallel runs use them directly
+    int& degree_fst=degrees[e.fst];
+    if (degree_fst==0) { // new vertex
       BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*); // sizeof(void*)=size of pointer
       DEGREE_BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*);
     }
+    degree_fst+=1;
 
-    if (degrees.count(e.snd)) {
-      degrees[e.snd]+=1;
-    } else {
-      degrees[e.snd]=1;
+    int& degree_snd=degrees[e.snd];
+    if (degree_snd==0) { // new vertex
       BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*); // sizeof(void*)=size of pointer
       DEGREE_BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*);
     }
+    degree_snd+=1;
 
     for (int j=0; j<c; j++) { // perform parallel runs
       int d1=max(1,(j*d)/c), d2=d/c; // calculate degree bounds for run
@@ -197,25 +196,25 @@ int single_pass_insertion_stream(int c, int d, int n, ifstream& stream, vector<v
       // NB rest is standard degree-restricted sampling
 
       // Consider adding first vertex to the reservoir
-      if (degrees[e.fst]==d1) {
+      if (degree_fst==d1) {
         count[j]+=1; // increment number of d1 degree vertexs
         update_reservoir(e.fst,d1,d2,count[j],size,*reservoirs[j],*edges[j]); // possibly add value to reservoir
       }
 
       // Consider adding second vertex to the reservoir
-      if (degrees[e.snd]==d1) {
+      if (degree_snd==d1) {
         count[j]+=1; // increment number of d1 degree vertexs
         update_reservoir(e.snd,d1,d2,count[j],size,*reservoirs[j],*edges[j]); // possibly add value to reservoir
       }
 
       if (find(reservoirs[j]->begin(),reservoirs[j]->end(),e.fst)!=reservoirs[j]->end()) { // if first endpoint is in reservoir
-        if (degrees[e.fst]<=d2+d1) {
+        if (degree_fst<=d2+d1) {
           edges[j]->push_back(e);
           BYTES+=sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
           RESERVOIR_BYTES+=sizeof(edge);
         }
-        if (degrees[e.fst]==d2+d1) { // sufficient neighbourhood has been found, return it
-          cout<<endl<<"*"<<degrees[e.fst]<<endl;
+        if (degree_fst==d2+d1) { // sufficient neighbourhood has been found, return it
+          cout<<endl<<"*"<<degree_fst<<endl;
           for (vector<edge>::iterator i=edges[j]->begin(); i!=edges[j]->end(); i++) { // construct neighbourhood to be returned
             if (i->fst==e.fst) neighbourhood.push_back(i->snd);
             else if (i->snd==e.fst) neighbourhood.push_back(i->fst);
@@ -226,13 +225,13 @@ int single_pass_insertion_stream(int c, int d, int n, ifstream& stream, vector<v
           return edge_count;
         }
       } else if (find(reservoirs[j]->begin(),reservoirs[j]->end(),e.snd)!=reservoirs[j]->end()) { // if second endpoint is in reservoir
-        if (degrees[e.snd]<=d2+d1) {
+        if (degree_snd<=d2+d1) {
           edges[j]->push_back(e);
           BYTES+=sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
           RESERVOIR_BYTES+=sizeof(edge);
         }
-        if (degrees[e.snd]==d2+d1) { // sufficient neighbourhood has been found, return it
-          cout<<endl<<"*"<<degrees[e.snd]<<endl;
+        if (degree_snd==d2+d1) { // sufficient neighbourhood has been found, return it
+          cout<<endl<<"*"<<degree_snd<<endl;
           for (vector<edge>::iterator i=edges[j]->begin(); i!=edges[j]->end(); i++) { // construct neighbourhood to be returned
             if (i->fst==e.snd) neighbourhood.push_back(i->snd);
             else if (i->snd==e.snd) neighbourhood.push_back(i->fst);
@@ -0,0 +1,313 @@
+/*-----------------*
+ * One pass c-approximation Streaming Algorithm for Neighbourhood Detection for Insertion-Only Graph Streams
+ *
+ * This implementation never terminates early, instead it is a long-lived engine for unbounded streams.
+ *  Whenever a vertex in one of the c reservoirs reaches degree d1+d2 (so d/c neighbours have been collected) an event is emitted,
+ *  either to a callback or to the engine's event queue, & the engine keeps its state so later neighbourhoods are also reported.
+ *  Each root is only reported once, over all runs.
+ *  After a root is reported it leaves every reservoir & its stored edges are freed, reported roots are not sampled again,
+ *  so the steady-state space is the same as insertionStreams.cpp plus one vertex per reported root.
+ *-----------------*/
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int BYTES; // space used atm
+int RESERVOIR_BYTES; // space used by reservoirs atm
+int DEGREE_BYTES; // space used to store degrees of vertices
+int MAX_BYTES; // max space used at any time
+
+/*-----------------*
+ * DATA STRUCTURES *
+ *-----------------*/
+
+using vertex = string; // typemap vertex
+using time_point=chrono::high_resolution_clock::time_point;
+
+struct edge { // undirected edge
+  vertex fst;
+  vertex snd;
+};
+
+struct neighbourhood_event { // a root which has been found to have a sufficiently large neighbourhood
+  int edge_count; // # edges read when the root was found
+  int run; // which parallel run found it
+  vertex root;
+  vector<vertex> neighbourhood;
+};
+
+using event_callback=void (*)(neighbourhood_event&);
+
+struct continuous_engine { // state of the algorithm, kept between edges
+  int c, d, size;
+  vector<vector<vertex> > reservoirs; // one per run
+  vector<vector<edge> > edges; // one per run
+  vector<int> count; // counts the number of vertexs >=d1 for each run
+  map<vertex,int> degrees; // shared for each run
+  set<vertex> reported; // roots which have already been reported
+  deque<neighbourhood_event> events; // events waiting to be consumed (if no callback is given)
+  event_callback callback; // called for each event (if not nullptr)
+  int edge_count;
+};
+
+/*-----------*
+* SIGNATURES *
+*------------*/
+
+// engine
+void initialise_engine(int c, int d, int n, event_callback callback, continuous_engine& engine);
+void process_edge(edge& e, continuous_engine& engine);
+int run_continuous(istream& stream, continuous_engine& engine); // process every edge of stream, returns # edges read
+bool poll_event(continuous_engine& engine, neighbourhood_event& event); // pop the oldest queued event
+
+// reservoir sampling
+void update_reservoir(vertex n, int count, int size, vector<vertex>& reservoir, vector<edge>& edges);
+void emit_event(int run, vertex root, continuous_engine& engine);
+void free_root_edges(vertex root, vector<vertex>& reservoir, vector<edge>& edges);
+
+// utility
+void parse_edge(string str, edge& e);
+void print_event(neighbourhood_event& event);
+
+/*-----*
+* BODY *
+*------*/
+
+int main() {
+  string out_file_path="results_continuous.csv";
+  int n,d,c; string edge_file_path;
+
+  // c=runs, d/c=d2, n=# vertices, NOTE - set d=max degree, n=number of vertices
+  //n=52; d=35; c=3; edge_file_path="../../data/facebook_small.edges"; // NOTE - # edges=292
+  //n=747; d=586; c=3; edge_file_path="../../data/facebook.edges"; // NOTE - # edges=60,050
+  n=12417; d=5948; c=5; edge_file_path="../../data/gplus.edges"; // NOTE - # edges=1,179,613
+
+  // queue interface, events are consumed after the stream (in production poll_event is called between batches of edges)
+  continuous_engine engine;
+  initialise_engine(c,d,n,nullptr,engine);
+  ifstream stream(edge_file_path);
+
+  time_point before=chrono::high_resolution_clock::now(); // time before execution
+  int edge_count=run_continuous(stream,engine);
+  time_point after=chrono::high_resolution_clock::now(); // time after execution
+  stream.close();
+
+  ofstream outfile(out_file_path);
+  outfile<<"name,"<<edge_file_path<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"c,"<<c<<endl<<"edges,"<<edge_count<<endl;
+  outfile<<"time (microseconds),"<<chrono::duration_cast<chrono::microseconds>(after-before).count()<<endl<<"max space (bytes),"<<MAX_BYTES<<endl<<endl;
+  outfile<<"edge count,run,root,neighbourhood size"<<endl; // headers
+  neighbourhood_event event;
+  while (poll_event(engine,event)) outfile<<event.edge_count<<","<<event.run<<","<<event.root<<","<<event.neighbourhood.size()<<endl;
+  outfile.close();
+
+  // callback interface, events are handled as soon as they happen
+  //initialise_engine(c,d,n,print_event,engine);
+  //run_continuous(cin,engine);
+
+  return 0;
+}
+
+/*--------*
+ * ENGINE *
+ *--------*/
+
+// prepare engine for a new stream, if callback is nullptr events are queued instead
+void initialise_engine(int c, int d, int n, event_callback callback, continuous_engine& engine) {
+  engine.c=c; engine.d=d;
+  engine.size=ceil(log10(n)*pow(n,(double)1/c));
+  engine.reservoirs.assign(c,vector<vertex>());
+  engine.edges.assign(c,vector<edge>());
+  engine.count.assign(c,0);
+  engine.degrees.clear(); engine.reported.clear(); engine.events.clear();
+  engine.callback=callback;
+  engine.edge_count=0;
+
+  BYTES=sizeof(continuous_engine)+c*(sizeof(vector<vertex>)+sizeof(vector<edge>)+sizeof(int));
+  RESERVOIR_BYTES=c*(sizeof(vector<vertex>)+sizeof(vector<edge>));
+  DEGREE_BYTES=sizeof(map<vertex,int>);
+  MAX_BYTES=BYTES;
+}
+
+// read edges until the stream ends
+int run_continuous(istream& stream, continuous_engine& engine) {
+  string line; edge e;
+  while (getline(stream,line)) { // While stream is not empty
+    parse_edge(line,e);
+    process_edge(e,engine);
+    if (engine.edge_count%10000==0) cout<<"\r"<<engine.edge_count<<" ("<<engine.reported.size()<<" reported)";
+  }
+  cout<<"\rDONE ("<<engine.reported.size()<<" reported)                         "<<endl;
+  return engine.edge_count;
+}
+
+// update every run with a new edge, emitting an event for each new root
+void process_edge(edge& e, continuous_engine& engine) {
+  int c=engine.c, d=engine.d;
+  map<vertex,int>& degrees=engine.degrees;
+  engine.edge_count+=1;
+
+  // increment degrees for each vertex
+  if (degrees.count(e.fst)) {
+    degrees[e.fst]+=1;
+  } else {
+    degrees[e.fst]=1;
+    BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*); // sizeof(void*)=size of pointer
+    DEGREE_BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*);
+  }
+
+  if (degrees.count(e.snd)) {
+    degrees[e.snd]+=1;
+  } else {
+    degrees[e.snd]=1;
+    BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*); // sizeof(void*)=size of pointer
+    DEGREE_BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*);
+  }
+
+  for (int j=0; j<c; j++) { // perform parallel runs
+    int d1=max(1,(j*d)/c), d2=d/c; // calculate degree bounds for run
+    vector<vertex>& reservoir=engine.reservoirs[j]; vector<edge>& edges=engine.edges[j];
+    // NB rest is standard degree-restricted sampling
+
+    // Consider adding first vertex to the reservoir, reported roots are not candidates
+    if (degrees[e.fst]==d1 && engine.reported.count(e.fst)==0) {
+      engine.count[j]+=1; // increment number of d1 degree vertexs
+      update_reservoir(e.fst,engine.count[j],engine.size,reservoir,edges); // possibly add value to reservoir
+    }
+
+    // Consider adding second vertex to the reservoir
+    if (degrees[e.snd]==d1 && engine.reported.count(e.snd)==0) {
+      engine.count[j]+=1; // increment number of d1 degree vertexs
+      update_reservoir(e.snd,engine.count[j],engine.size,reservoir,edges); // possibly add value to reservoir
+    }
+
+    // a reported root is not in any reservoir (see emit_event), so an edge to one is considered for its other endpoint
+    if (engine.reported.count(e.fst)==0 && find(reservoir.begin(),reservoir.end(),e.fst)!=reservoir.end()) { // if first endpoint is in reservoir
+      if (degrees[e.fst]<=d2+d1) {
+        edges.push_back(e);
+        BYTES+=sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+        RESERVOIR_BYTES+=sizeof(edge);
+      }
+      if (degrees[e.fst]==d2+d1) emit_event(j,e.fst,engine); // sufficient neighbourhood has been found, report it
+    } else if (engine.reported.count(e.snd)==0 && find(reservoir.begin(),reservoir.end(),e.snd)!=reservoir.end()) { // if second endpoint is in reservoir
+      if (degrees[e.snd]<=d2+d1) {
+        edges.push_back(e);
+        BYTES+=sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+        RESERVOIR_BYTES+=sizeof(edge);
+      }
+      if (degrees[e.snd]==d2+d1) emit_event(j,e.snd,engine); // sufficient neighbourhood has been found, report it
+    }
+  }
+}
+
+// remove oldest event from queue, returns false if there are none
+bool poll_event(continuous_engine& engine, neighbourhood_event& event) {
+  if (engine.events.size()==0) return false;
+  event=engine.events.front();
+  engine.events.pop_front();
+  return true;
+}
+
+/*--------------------*
+ * RESERVOIR SAMPLING *
+ *--------------------*/
+
+void update_reservoir(vertex n, int count, int size, vector<vertex>& reservoir, vector<edge>& edges) {
+  if (reservoir.size()<size) { // reservoir is not full
+    reservoir.push_back(n);
+    BYTES+=sizeof(vertex); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+    RESERVOIR_BYTES+=sizeof(vertex);
+  } else { // reservoir is full
+    default_random_engine generator;
+    generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+    bernoulli_distribution bernoulli_d((float)size/(float)count);
+    if (bernoulli_d(generator)) { // if coin flip passes
+      uniform_int_distribution<unsigned long> uniform_d(0,size-1); // decide which vertex to delete
+      int to_delete=uniform_d(generator);
+
+      vertex to_delete_val=reservoir[to_delete];
+      reservoir.erase(reservoir.begin()+to_delete);
+      reservoir.push_back(n);
+      // NB No space change
+
+      free_root_edges(to_delete_val,reservoir,edges);
+    }
+  }
+}
+
+// record root as reported, construct its neighbourhood & pass to callback (or queue)
+void emit_event(int run, vertex root, continuous_engine& engine) {
+  neighbourhood_event event;
+  event.edge_count=engine.edge_count; event.run=run; event.root=root;
+  vector<edge>& edges=engine.edges[run];
+  for (vector<edge>::iterator i=edges.begin(); i!=edges.end(); i++) { // construct neighbourhood to be reported
+    if (i->fst==root) event.neighbourhood.push_back(i->snd);
+    else if (i->snd==root) event.neighbourhood.push_back(i->fst);
+  }
+
+  engine.reported.insert(root);
+  BYTES+=sizeof(vertex)+2*sizeof(void*); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+
+  // root leaves the reservoir of every run so its slot can be refilled, its edges are no longer needed (unless adjacent to another vertex in the reservoir)
+  for (int j=0; j<engine.c; j++) {
+    vector<vertex>& reservoir=engine.reservoirs[j];
+    vector<vertex>::iterator it=find(reservoir.begin(),reservoir.end(),root);
+    if (it==reservoir.end()) continue;
+    reservoir.erase(it);
+    BYTES-=sizeof(vertex); RESERVOIR_BYTES-=sizeof(vertex);
+    free_root_edges(root,reservoir,engine.edges[j]);
+  }
+
+  if (engine.callback!=nullptr) engine.callback(event);
+  else engine.events.push_back(event);
+}
+
+// removes edges adjacent to root (which are not adjacent to another vertex in the reservoir)
+void free_root_edges(vertex root, vector<vertex>& reservoir, vector<edge>& edges) {
+  vector<edge>::iterator i=edges.begin();
+  while (i!=edges.end()) {
+    if ((i->fst==root && (i->snd==root || find(reservoir.begin(),reservoir.end(),i->snd)==reservoir.end()))
+      || (i->snd==root && find(reservoir.begin(),reservoir.end(),i->fst)==reservoir.end())) { // edge not adjacent to another value in the reservoir
+      i=edges.erase(i); // next edge
+      BYTES-=sizeof(edge);RESERVOIR_BYTES-=sizeof(edge);
+    } else i++; // next edge
+  }
+}
+
+/*-----------*
+ * UTILITIES *
+ *-----------*/
+
+// parse ege from stream
+void parse_edge(string str, edge& e) {
+  string fst="",snd="";
+  bool after=false;
+
+  for (char& c:str) {
+    if (c==' ') { // seperator
+      after=true;
+    } else if (after) { // second id
+      snd+=c;
+    } else { // first id
+      fst+=c;
+    }
+  }
+
+  // Update edge values
+  e.fst=fst;e.snd=snd;
+}
+
+// example callback, prints event to terminal
+void print_event(neighbourhood_event& event) {
+  cout<<endl<<"EVENT edge="<<event.edge_count<<" run="<<event.run<<" root="<<event.root<<" ("<<event.neighbourhood.size()<<")"<<endl;
+}
@@ -0,0 +1,453 @@
+/*-----------------*
+ * One pass c-approximation Streaming Algorithm for Neighbourhood Detection for Insertion-Only Graph Streams
+ *
+ * This uses the implementation which terminates early AND only runs the samplers in [bot_sampler,top_sampler) (see insertionStreamsRemovedSamplers.cpp)
+ * Samplers j>=hh_sampler do not use the exact degree table, instead a SpaceSaving heavy-hitter summary with k counters is used to filter candidates.
+ *  Only vertices with degree>=d1=j*d/c matter to sampler j & there are at most 2m/d1 of them, so with k>=2m/d1 every such vertex is tracked.
+ *  Vertices which are not tracked by the summary skip the degree table & reservoirs, so if bot_sampler>=hh_sampler the degree space is O(k) not O(n).
+ *-----------------*/
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int BYTES; // space used atm
+int RESERVOIR_BYTES; // space used by reservoirs atm
+int DEGREE_BYTES; // space used to store degrees of vertices (exact table & heavy-hitter summary)
+int MAX_BYTES; // max space used at any time
+int MAX_RESERVOIR_BYTES; // max space used by reservoirs
+
+/*-----------------*
+ * DATA STRUCTURES *
+ *-----------------*/
+
+using vertex = string; // typemap vertex
+using time_point=chrono::high_resolution_clock::time_point;
+
+struct edge { // undirected edge
+  vertex fst;
+  vertex snd;
+};
+
+struct space_saving { // SpaceSaving summary (Metwally et al.), estimates are upper bounds on true degrees
+  int k; // max number of counters
+  map<vertex,int> counts; // tracked vertex -> estimated degree
+  set<pair<int,vertex> > order; // (estimated degree, vertex) so the min counter can be found
+};
+
+/*-----------*
+* SIGNATURES *
+*------------*/
+
+void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, int m, string file_name, string out_file); // m=# edges, used to size the heavy-hitter summary
+
+// main algorithm
+int single_pass_insertion_stream(int c, int d, int n, int k, ifstream& stream, vector<vertex>& neighbourhood, vertex& root, int bot_sampler, int top_sampler, int hh_sampler);
+
+// heavy hitters
+int choose_num_counters(int c, int d, int m, int hh_sampler);
+int space_saving_increment(vertex v, space_saving& summary); // returns new estimate of degree
+int space_saving_estimate(vertex v, space_saving& summary); // returns 0 if not tracked
+
+// reservoir sampling
+void update_reservoir(vertex n, int d1, int d2, int count, int size, vector<vertex>& reservoir, vector<edge>& edges);
+bool collect_neighbourhood(vertex v, int d2, vector<edge>& edges, vector<vertex>& neighbourhood);
+
+// utility
+void parse_edge(string str, edge& e);
+double variance(vector<int> vals);
+
+/*-----*
+* BODY *
+*------*/
+
+int main() {
+  string out_file_path;
+  int n,d,m,reps; string edge_file_path;
+
+  // c=runs, d/c=d2, n=# vertices, m=# edges, NOTE - set d=max degree, n=number of vertices
+  //n=12417; d=5948; m=1179613; reps=10; edge_file_path="../../data/gplus.edges";
+  //n=52; d=35; m=292; reps=10; edge_file_path="../../data/facebook_small.edges";
+  //n=747; d=586; m=60050; reps=10; edge_file_path="../../data/facebook.edges";
+
+  n=102100; d=104947; m=30238035; reps=10; edge_file_path="../../data/gplus_large.edges";
+  out_file_path="results_heavy_hitters_gplus_large.csv";
+  execute_test(2,20,1,reps,d,n,m,edge_file_path,out_file_path);
+
+  return 0;
+}
+
+// Runs algorithm multiple time, writing results to a csv file
+// Runs both with the exact degree table for every sampler (hh_sampler=top_sampler) & with the heavy-hitter summary for samplers j>=1
+void execute_test(int c_min, int c_max, int c_step, int reps, int d, int n, int m, string file_name, string out_file) {
+  ofstream outfile(out_file);
+  outfile<<"name,"<<file_name<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"m,"<<m<<endl<<"repetitions,"<<reps<<endl<<"k,ceil(2m/((hh_sampler*d)/c))"<<endl<<endl; // test details
+  outfile<<"c,bot_sampler,top_sampler,hh_sampler,k,time (microseconds),mean max space (bytes),mean reservoir space (bytes),mean degree space (bytes),mean edges checked,variance time, variance max space,variance reservoir space, variance degree space,varriance edges checked,successes"<<endl; // headers
+  vector<vertex> neighbourhood; vertex root; // variables for returned values
+  vector<int> times, total_space, reservoir_space, degree_space, edges_checked; // results of each run of c
+  int successes;
+  for (int c=c_max;c>=c_min;c-=c_step) {
+    int bot_sampler=1, top_sampler=c; // sampler 0 has d1=1 so every vertex is a candidate, the summary can't filter it
+    for (int hh_sampler=top_sampler; hh_sampler>=bot_sampler; hh_sampler-=top_sampler-bot_sampler) { // without then with the summary
+      int k=(hh_sampler<top_sampler) ? choose_num_counters(c,d,m,hh_sampler) : 0;
+      times.clear(); total_space.clear(); reservoir_space.clear(); degree_space.clear(); edges_checked.clear();// reset for new run of c
+      successes=0;
+
+      for (int i=0;i<reps;i++) {
+        cout<<"("<<i<<"/"<<reps<<") "<<c<<"/"<<c_max<<" "<<"<"<<bot_sampler<<"/"<<hh_sampler<<"/"<<top_sampler<<"> k="<<k<<endl; // output to terminal
+
+        // reset values
+        BYTES=0; RESERVOIR_BYTES=0; DEGREE_BYTES=0; MAX_BYTES=0; MAX_RESERVOIR_BYTES=0;
+        neighbourhood.clear(); vertex* p=&root; p=nullptr;
+        ifstream stream(file_name); // file to read
+
+        time_point before=chrono::high_resolution_clock::now(); // time before execution
+        edges_checked.push_back(single_pass_insertion_stream(c,d,n,k,stream,neighbourhood,root,bot_sampler,top_sampler,hh_sampler));
+        time_point after=chrono::high_resolution_clock::now(); // time after execution
+
+        cout<<root<<endl;
+        cout<<neighbourhood.size()<<"("<<d/c<<")"<<endl;
+
+        stream.close();
+
+        if (neighbourhood.size()!=0) successes+=1;
+
+        auto duration = chrono::duration_cast<chrono::microseconds>(after-before).count(); // time passed
+        cout<<duration/1000000<<"s"<<endl<<endl;
+        if (RESERVOIR_BYTES>MAX_RESERVOIR_BYTES) MAX_RESERVOIR_BYTES=RESERVOIR_BYTES;
+        times.push_back(duration); total_space.push_back(MAX_BYTES); reservoir_space.push_back(MAX_RESERVOIR_BYTES); degree_space.push_back(DEGREE_BYTES);
+      }
+      int mean_duration      =accumulate(times.begin(),times.end(),0)/times.size();
+      int mean_total_space   =accumulate(total_space.begin(),total_space.end(),0)/total_space.size();
+      int mean_reservoir_space=accumulate(reservoir_space.begin(),reservoir_space.end(),0)/reservoir_space.size();
+      int mean_degree_space  =accumulate(degree_space.begin(),degree_space.end(),0)/degree_space.size();
+      int mean_edges_checked =accumulate(edges_checked.begin(),edges_checked.end(),0)/edges_checked.size();
+
+      double variance_duration      =variance(times);
+      double variance_total_space   =variance(total_space);
+      double variance_reservoir_space=variance(reservoir_space);
+      double variance_degree_space  =variance(degree_space);
+      double variance_edges_checked =variance(edges_checked);
+
+      outfile<<c<<","<<bot_sampler<<","<<top_sampler<<","<<hh_sampler<<","<<k<<","<<mean_duration<<","<<mean_total_space<<","<<mean_reservoir_space<<","<<mean_degree_space<<","<<mean_edges_checked<<","<<variance_duration<<","<<variance_total_space<<","<<variance_reservoir_space<<","<<variance_degree_space<<","<<variance_edges_checked<<","<<successes<<endl; // write values to file
+      if (top_sampler==bot_sampler) break;
+    }
+  }
+  outfile.close();
+}
+
+// perform reservoir sampling
+// samplers j in [bot_sampler,hh_sampler) use exact degrees, samplers j in [hh_sampler,top_sampler) use the heavy-hitter summary
+// returns number of edges which are read
+int single_pass_insertion_stream(int c, int d, int n, int k, ifstream& stream, vector<vertex>& neighbourhood, vertex& root, int bot_sampler, int top_sampler, int hh_sampler) {
+  int size=ceil(log10(n)*pow(n,(double)1/c));
+  int num_samplers=top_sampler-bot_sampler;
+  bool exact_degrees=(bot_sampler<hh_sampler); // only need the O(n) table if a sampler uses it
+  bool hh_degrees=(hh_sampler<top_sampler);
+
+  // initalise edge & vector sets for each parallel run
+  vector<vertex>* reservoirs[num_samplers]; vector<edge>* edges[num_samplers];
+  for (int i=0; i<num_samplers; i++) {
+    reservoirs[i]=new vector<vertex>;
+    edges[i]=new vector<edge>;
+  }
+  BYTES+=num_samplers*(sizeof(vector<vertex>)+sizeof(vector<edge>));
+  RESERVOIR_BYTES+=num_samplers*(sizeof(vector<vertex>)+sizeof(vector<edge>));
+
+  string line; edge e; map<vertex,int> degrees; // these are shared for each run
+  space_saving summary; summary.k=k;
+  int count[num_samplers];  // counts the number of vertexs >=d1
+  for (int i=0; i<num_samplers; i++) count[i]=0;
+  BYTES+=sizeof(string)+sizeof(edge)+sizeof(map<vertex,int>)+sizeof(space_saving)+num_samplers*sizeof(int);
+  DEGREE_BYTES+=sizeof(map<vertex,int>)+sizeof(space_saving);
+
+  int edge_count=0;
+  while (getline(stream,line)) { // While stream is not empty
+    parse_edge(line,e);
+    edge_count+=1;
+    if (edge_count%10000==0) cout<<"\r"<<edge_count;
+
+    // increment exact degrees for each vertex
+    int fst_degree=0, snd_degree=0;
+    if (exact_degrees) {
+      if (degrees.count(e.fst)) {
+        degrees[e.fst]+=1;
+      } else {
+        degrees[e.fst]=1;
+        BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*); // sizeof(void*)=size of pointer
+        DEGREE_BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*);
+      }
+
+      if (degrees.count(e.snd)) {
+        degrees[e.snd]+=1;
+      } else {
+        degrees[e.snd]=1;
+        BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*); // sizeof(void*)=size of pointer
+        DEGREE_BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*);
+      }
+      fst_degree=degrees[e.fst]; snd_degree=degrees[e.snd];
+    }
+
+    // increment estimated degrees, estimates before the update are kept to spot vertices crossing d1
+    int fst_estimate=0, snd_estimate=0, fst_prev=0, snd_prev=0;
+    if (hh_degrees) {
+      fst_prev=space_saving_estimate(e.fst,summary); fst_estimate=space_saving_increment(e.fst,summary);
+      snd_prev=space_saving_estimate(e.snd,summary); snd_estimate=space_saving_increment(e.snd,summary);
+      if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+    }
+
+    for (int j=bot_sampler; j<top_sampler; j++) { // perform parallel runs
+      int index=j-bot_sampler;
+      int d1=max(1,(j*d)/c), d2=d/c; // calculate degree bounds for run
+      BYTES+=sizeof(int);
+
+      if (j<hh_sampler) { // NB standard degree-restricted sampling
+        // Consider adding first vertex to the reservoir
+        if (fst_degree==d1) {
+          count[index]+=1; // increment number of d1 degree vertexs
+          update_reservoir(e.fst,d1,d2,count[index],size,*reservoirs[index],*edges[index]); // possibly add value to reservoir
+        }
+
+        // Consider adding second vertex to the reservoir
+        if (snd_degree==d1) {
+          count[index]+=1; // increment number of d1 degree vertexs
+          update_reservoir(e.snd,d1,d2,count[index],size,*reservoirs[index],*edges[index]); // possibly add value to reservoir
+        }
+
+        if (find(reservoirs[index]->begin(),reservoirs[index]->end(),e.fst)!=reservoirs[index]->end()) { // if first endpoint is in reservoir
+          if (fst_degree<=d2+d1) {
+            edges[index]->push_back(e);
+            BYTES+=sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+            RESERVOIR_BYTES+=sizeof(edge);
+          }
+          if (fst_degree==d2+d1 && collect_neighbourhood(e.fst,d2,*edges[index],neighbourhood)) { // sufficient neighbourhood has been found, return it
+            cout<<endl<<"*"<<fst_degree<<endl;
+            BYTES+=neighbourhood.size()*sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+            RESERVOIR_BYTES+=neighbourhood.size()*sizeof(edge);
+            root=e.fst;
+            return edge_count;
+          }
+        } else if (find(reservoirs[index]->begin(),reservoirs[index]->end(),e.snd)!=reservoirs[index]->end()) { // if second endpoint is in reservoir
+          if (snd_degree<=d2+d1) {
+            edges[index]->push_back(e);
+            BYTES+=sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+            RESERVOIR_BYTES+=sizeof(edge);
+          }
+          if (snd_degree==d2+d1 && collect_neighbourhood(e.snd,d2,*edges[index],neighbourhood)) { // sufficient neighbourhood has been found, return it
+            cout<<endl<<"*"<<snd_degree<<endl;
+            BYTES+=neighbourhood.size()*sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+            RESERVOIR_BYTES+=neighbourhood.size()*sizeof(edge);
+            root=e.snd;
+            return edge_count;
+          }
+        }
+
+      } else { // heavy-hitter filtered sampling
+        // NB estimates can jump when a vertex replaces the min counter, so check for crossing d1 rather than equality
+        if (fst_prev<d1 && fst_estimate>=d1) {
+          count[index]+=1;
+          update_reservoir(e.fst,d1,d2,count[index],size,*reservoirs[index],*edges[index]);
+        }
+
+        if (snd_prev<d1 && snd_estimate>=d1) {
+          count[index]+=1;
+          update_reservoir(e.snd,d1,d2,count[index],size,*reservoirs[index],*edges[index]);
+        }
+
+        // NB estimates are upper bounds so the d1+d2 cap can't be trusted, instead collect until d2 edges are known
+        // Once a vertex is in the reservoir every incident edge increases its estimate so at most d2 edges are stored for it
+        if (find(reservoirs[index]->begin(),reservoirs[index]->end(),e.fst)!=reservoirs[index]->end()) { // if first endpoint is in reservoir
+          edges[index]->push_back(e);
+          BYTES+=sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+          RESERVOIR_BYTES+=sizeof(edge);
+          if (fst_estimate>=d2+d1 && collect_neighbourhood(e.fst,d2,*edges[index],neighbourhood)) { // sufficient neighbourhood has been found, return it
+            cout<<endl<<"*"<<fst_estimate<<endl;
+            BYTES+=neighbourhood.size()*sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+            RESERVOIR_BYTES+=neighbourhood.size()*sizeof(edge);
+            root=e.fst;
+            return edge_count;
+          }
+        } else if (find(reservoirs[index]->begin(),reservoirs[index]->end(),e.snd)!=reservoirs[index]->end()) { // if second endpoint is in reservoir
+          edges[index]->push_back(e);
+          BYTES+=sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+          RESERVOIR_BYTES+=sizeof(edge);
+          if (snd_estimate>=d2+d1 && collect_neighbourhood(e.snd,d2,*edges[index],neighbourhood)) { // sufficient neighbourhood has been found, return it
+            cout<<endl<<"*"<<snd_estimate<<endl;
+            BYTES+=neighbourhood.size()*sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+            RESERVOIR_BYTES+=neighbourhood.size()*sizeof(edge);
+            root=e.snd;
+            return edge_count;
+          }
+        }
+      }
+      BYTES-=sizeof(int); // deletion of d1
+    }
+
+  }
+  cout<<"\rDONE                         "<<endl;
+
+  // No sucessful runs
+  neighbourhood.clear();
+  vertex* p=&root;
+  p=nullptr;
+
+  return edge_count;
+}
+
+/*---------------*
+ * HEAVY HITTERS *
+ *---------------*/
+
+// number of counters needed so every vertex of degree>=d1 of sampler hh_sampler is guaranteed to be tracked
+// sum of degrees is 2m so at most 2m/d1 vertices have degree>=d1 & SpaceSaving tracks every item with frequency>2m/k
+int choose_num_counters(int c, int d, int m, int hh_sampler) {
+  int d1=max(1,(hh_sampler*d)/c);
+  return ceil((2*(double)m)/d1)+1;
+}
+
+// increment degree of vertex, if it is not tracked it replaces the vertex with the min estimate (inheriting its count)
+int space_saving_increment(vertex v, space_saving& summary) {
+  map<vertex,int>::iterator it=summary.counts.find(v);
+  int estimate;
+
+  if (it!=summary.counts.end()) { // already tracked
+    estimate=it->second;
+    summary.order.erase(pair<int,vertex>(estimate,v));
+    estimate+=1;
+    it->second=estimate;
+  } else if (summary.counts.size()<summary.k) { // free counter
+    estimate=1;
+    summary.counts[v]=estimate;
+    BYTES+=2*(sizeof(vertex)+sizeof(int)+sizeof(void*));
+    DEGREE_BYTES+=2*(sizeof(vertex)+sizeof(int)+sizeof(void*));
+  } else { // replace min counter
+    set<pair<int,vertex> >::iterator min_it=summary.order.begin();
+    estimate=min_it->first+1;
+    summary.counts.erase(min_it->second);
+    summary.order.erase(min_it);
+    summary.counts[v]=estimate;
+    // NB No space change
+  }
+  summary.order.insert(pair<int,vertex>(estimate,v));
+
+  return estimate;
+}
+
+// current estimate of degree of vertex
+int space_saving_estimate(vertex v, space_saving& summary) {
+  map<vertex,int>::iterator it=summary.counts.find(v);
+  if (it==summary.counts.end()) return 0;
+  return it->second;
+}
+
+/*--------------------*
+ * RESERVOIR SAMPLING *
+ *--------------------*/
+
+void update_reservoir(vertex n, int d1, int d2, int count, int size, vector<vertex>& reservoir, vector<edge>& edges) {
+  if (reservoir.size()<size) { // reservoir is not full
+    reservoir.push_back(n);
+    BYTES+=sizeof(vertex); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+    RESERVOIR_BYTES+=2*sizeof(vertex);
+  } else { // reservoir is full
+    default_random_engine generator;
+    generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+    bernoulli_distribution bernoulli_d((float)size/(float)count);
+    BYTES+=sizeof(default_random_engine)+sizeof(bernoulli_distribution);
+    if (bernoulli_d(generator)) { // if coin flip passes
+      uniform_int_distribution<unsigned long> uniform_d(0,size-1); // decide which vertex to delete
+      int to_delete=uniform_d(generator);
+
+      vertex to_delete_val=reservoir[to_delete];
+      BYTES+=2*sizeof(vertex);
+      RESERVOIR_BYTES+=2*sizeof(vertex);
+      if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+
+      reservoir.erase(reservoir.begin()+to_delete);
+      reservoir.push_back(n);
+      // NB No space change
+
+      // removes edges adjacent to vertex to be deleted (which are not adjacent to another vertex in the reservoir)
+      vector<edge>::iterator i=edges.begin();
+      while (i!=edges.end()) {
+
+        if (i->fst==to_delete_val) {
+          if (find(reservoir.begin(),reservoir.end(),i->snd)==reservoir.end()) { // edge not adjacent to another value in the reservoir
+            i=edges.erase(i); // next edge
+            if (RESERVOIR_BYTES>MAX_RESERVOIR_BYTES) MAX_RESERVOIR_BYTES=RESERVOIR_BYTES;
+            BYTES-=sizeof(edge);RESERVOIR_BYTES-=sizeof(edge);
+          } else i++; // next edge
+
+        } else if (i->snd==to_delete_val) {
+          if (find(reservoir.begin(),reservoir.end(),i->fst)==reservoir.end()) { // edge not adjacent to another value in the reservoir
+            i=edges.erase(i); // next edge
+            if (RESERVOIR_BYTES>MAX_RESERVOIR_BYTES) MAX_RESERVOIR_BYTES=RESERVOIR_BYTES;
+            BYTES-=sizeof(edge);RESERVOIR_BYTES-=sizeof(edge);
+          } else i++; // next edge
+
+        } else i++; // next edge
+
+      }
+      BYTES-=2*sizeof(int);
+    }
+    BYTES-=sizeof(default_random_engine)+sizeof(bernoulli_distribution);
+  }
+}
+
+// construct neighbourhood of v from stored edges
+// returns true if at least d2 neighbours are stored (otherwise neighbourhood is left empty)
+bool collect_neighbourhood(vertex v, int d2, vector<edge>& edges, vector<vertex>& neighbourhood) {
+  neighbourhood.clear();
+  for (vector<edge>::iterator i=edges.begin(); i!=edges.end(); i++) { // construct neighbourhood to be returned
+    if (i->fst==v) neighbourhood.push_back(i->snd);
+    else if (i->snd==v) neighbourhood.push_back(i->fst);
+  }
+  if (neighbourhood.size()>=d2) return true;
+  neighbourhood.clear();
+  return false;
+}
+
+/*-----------*
+ * UTILITIES *
+ *-----------*/
+
+// parse ege from stream
+void parse_edge(string str, edge& e) {
+  string fst="",snd="";
+  bool after=false;
+
+  for (char& c:str) {
+    if (c==' ') { // seperator
+      after=true;
+    } else if (after) { // second id
+      snd+=c;
+    } else { // first id
+      fst+=c;
+    }
+  }
+
+  // Update edge values
+  e.fst=fst;e.snd=snd;
+}
+
+// return variance of values in a vector
+double variance(vector<int> vals) {
+  if (vals.size()<=1) return 0;
+  double var=0;
+  double mean=accumulate(vals.begin(),vals.end(),0)/vals.size();
+
+  for (vector<int>::iterator it=vals.begin(); it!=vals.end(); it++) var+=(*it-mean)*(*it-mean);
+  var/=(vals.size()-1);
+
+  return var;
+}
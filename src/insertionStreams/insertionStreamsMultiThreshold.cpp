@@ -0,0 +1,344 @@
+/*-----------------*
+ * One pass c-approximation Streaming Algorithm for Neighbourhood Detection for Insertion-Only Graph Streams
+ *
+ * This implementation answers many (c,d) queries in a single pass, each query terminating after its first sufficiently large neighbourhood.
+ *  The stream is parsed once & one degree table is shared by every query.
+ *  Run j of query (c,d) samples vertices reaching d1=j*d/c, & since many j*d/c coincide (e.g. 1/2=2/4) runs with the same d1 share one reservoir.
+ *  Reservoirs use bottom-k (priority) sampling, the `size` lowest priorities of a shared reservoir are a uniform sample of that size,
+ *   so a shared reservoir holds the largest size of its queries & each query only uses its own lowest `size` vertices.
+ *  Edges of a shared reservoir are kept up to d1+d2 for the largest d2 of its queries which are still running.
+ *-----------------*/
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int BYTES; // space used atm
+int RESERVOIR_BYTES; // space used by reservoirs atm
+int DEGREE_BYTES; // space used to store degrees of vertices
+int MAX_BYTES; // max space used at any time
+
+/*-----------------*
+ * DATA STRUCTURES *
+ *-----------------*/
+
+using vertex = string; // typemap vertex
+using time_point=chrono::high_resolution_clock::time_point;
+
+struct edge { // undirected edge
+  vertex fst;
+  vertex snd;
+};
+
+struct shared_reservoir { // reservoir for every run with degree bound d1
+  int d1;
+  int size; // max size of queries using it
+  vector<int> queries; // indices of queries using it
+  vector<vertex> vertices;
+  vector<double> priorities; // keep vertices with lowest priorities
+  vector<edge> edges;
+};
+
+struct query { // a (c,d) configuration & its result
+  int c, d;
+  int size, d2;
+  bool done;
+  int edges_checked;
+  long duration; // microseconds from start of pass to result
+  vertex root;
+  vector<vertex> neighbourhood;
+};
+
+/*-----------*
+* SIGNATURES *
+*------------*/
+
+void execute_test(vector<pair<int,int> > configs, int reps, int n, string file_name, string out_file); // configs=(c,d) pairs
+
+// main algorithm
+int multi_threshold_insertion_stream(int n, ifstream& stream, vector<query>& queries, int& num_reservoirs); // returns # edges read
+
+// reservoir sampling
+void plan_reservoirs(int n, vector<query>& queries, vector<shared_reservoir>& reservoirs);
+void update_reservoir(vertex n, shared_reservoir& reservoir, default_random_engine& generator);
+int sample_rank(vertex v, shared_reservoir& reservoir); // # vertices in reservoir with lower priority than v
+
+// utility
+void parse_edge(string str, edge& e);
+double variance(vector<int> vals);
+
+/*-----*
+* BODY *
+*------*/
+
+int main() {
+  string out_file_path;
+  int n,d,reps; string edge_file_path;
+  vector<pair<int,int> > configs;
+
+  // d/c=d2, n=# vertices, NOTE - set d=max degree, n=number of vertices
+  //n=12417; d=5948; reps=10; edge_file_path="../../data/gplus.edges"; // NOTE - # edges=1,179,613
+  //n=747; d=586; reps=10; edge_file_path="../../data/facebook.edges"; // NOTE - # edges=60,050
+
+  n=102100; d=104947; reps=10; edge_file_path="../../data/gplus_large.edges"; // NOTE - # edges=30,238,035
+  for (int c=41; c<=100; c++) configs.push_back(pair<int,int>(c,d));
+  out_file_path="results_multi_threshold_gplus_large.csv";
+  execute_test(configs,reps,n,edge_file_path,out_file_path);
+
+  return 0;
+}
+
+// Runs every config in one pass, reps times, writing results to a csv file
+void execute_test(vector<pair<int,int> > configs, int reps, int n, string file_name, string out_file) {
+  int num_configs=configs.size();
+  vector<vector<int> > times(num_configs), edges_checked(num_configs); // results of each config
+  vector<int> successes(num_configs,0), pass_times, pass_space;
+  int num_reservoirs=0, total_runs=0;
+  for (int q=0; q<num_configs; q++) total_runs+=configs[q].first;
+
+  for (int i=0;i<reps;i++) {
+    cout<<"("<<i<<"/"<<reps<<") "<<num_configs<<" configs"<<endl; // output to terminal
+
+    // reset values
+    BYTES=0; RESERVOIR_BYTES=0; DEGREE_BYTES=0; MAX_BYTES=0;
+    vector<query> queries(num_configs);
+    for (int q=0; q<num_configs; q++) {queries[q].c=configs[q].first; queries[q].d=configs[q].second;}
+    ifstream stream(file_name); // file to read
+
+    time_point before=chrono::high_resolution_clock::now(); // time before execution
+    multi_threshold_insertion_stream(n,stream,queries,num_reservoirs);
+    time_point after=chrono::high_resolution_clock::now(); // time after execution
+    stream.close();
+
+    for (int q=0; q<num_configs; q++) {
+      if (queries[q].neighbourhood.size()!=0) successes[q]+=1;
+      times[q].push_back(queries[q].duration); edges_checked[q].push_back(queries[q].edges_checked);
+    }
+    pass_times.push_back(chrono::duration_cast<chrono::microseconds>(after-before).count()); pass_space.push_back(MAX_BYTES);
+  }
+
+  ofstream outfile(out_file);
+  outfile<<"name,"<<file_name<<endl<<"n,"<<n<<endl<<"repetitions,"<<reps<<endl<<"runs,"<<total_runs<<endl<<"shared reservoirs,"<<num_reservoirs<<endl; // test details
+  outfile<<"mean pass time (microseconds),"<<accumulate(pass_times.begin(),pass_times.end(),0)/pass_times.size()<<endl<<"mean max space (bytes),"<<accumulate(pass_space.begin(),pass_space.end(),0)/pass_space.size()<<endl<<endl;
+  outfile<<"c,d,time to result (microseconds),mean edges checked,variance time,varriance edges checked,successes"<<endl; // headers
+  for (int q=0; q<num_configs; q++) {
+    int mean_duration     =accumulate(times[q].begin(),times[q].end(),0)/times[q].size();
+    int mean_edges_checked=accumulate(edges_checked[q].begin(),edges_checked[q].end(),0)/edges_checked[q].size();
+    outfile<<configs[q].first<<","<<configs[q].second<<","<<mean_duration<<","<<mean_edges_checked<<","<<variance(times[q])<<","<<variance(edges_checked[q])<<","<<successes[q]<<endl; // write values to file
+  }
+  outfile.close();
+}
+
+// perform reservoir sampling for every query at once
+// returns number of edges which are read
+int multi_threshold_insertion_stream(int n, ifstream& stream, vector<query>& queries, int& num_reservoirs) {
+  time_point start=chrono::high_resolution_clock::now();
+  vector<shared_reservoir> reservoirs;
+  plan_reservoirs(n,queries,reservoirs);
+  num_reservoirs=reservoirs.size();
+  BYTES+=reservoirs.size()*sizeof(shared_reservoir)+queries.size()*sizeof(query);
+  RESERVOIR_BYTES+=reservoirs.size()*sizeof(shared_reservoir);
+
+  default_random_engine generator;
+  generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+
+  string line; edge e; map<vertex,int> degrees; // these are shared for each query
+  BYTES+=sizeof(string)+sizeof(edge)+sizeof(map<vertex,int>)+sizeof(default_random_engine);
+  DEGREE_BYTES+=sizeof(map<vertex,int>);
+
+  int edge_count=0, remaining=queries.size();
+  while (remaining>0 && getline(stream,line)) { // While stream is not empty & some query is unanswered
+    parse_edge(line,e);
+    edge_count+=1;
+    if (edge_count%10000==0) cout<<"\r"<<edge_count<<" ("<<remaining<<" remaining)";
+
+    // increment degrees for each vertex
+    if (degrees.count(e.fst)) {
+      degrees[e.fst]+=1;
+    } else {
+      degrees[e.fst]=1;
+      BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*); // sizeof(void*)=size of pointer
+      DEGREE_BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*);
+    }
+
+    if (degrees.count(e.snd)) {
+      degrees[e.snd]+=1;
+    } else {
+      degrees[e.snd]=1;
+      BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*); // sizeof(void*)=size of pointer
+      DEGREE_BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*);
+    }
+    int fst_degree=degrees[e.fst], snd_degree=degrees[e.snd];
+
+    for (vector<shared_reservoir>::iterator r=reservoirs.begin(); r!=reservoirs.end(); r++) { // perform parallel runs
+      // largest d2 of running queries, d2=d/c is 0 for c>d so whether any query is running is tracked separately
+      int max_d2=0; bool running=false;
+      for (vector<int>::iterator q=r->queries.begin(); q!=r->queries.end(); q++) {
+        if (queries[*q].done) continue;
+        max_d2=max(max_d2,queries[*q].d2);
+        running=true;
+      }
+      if (!running) continue; // every query using this reservoir is done
+      int d1=r->d1;
+
+      // Consider adding endpoints to the reservoir
+      if (fst_degree==d1) update_reservoir(e.fst,*r,generator);
+      if (snd_degree==d1) update_reservoir(e.snd,*r,generator);
+
+      vertex v; int v_degree;
+      if (find(r->vertices.begin(),r->vertices.end(),e.fst)!=r->vertices.end()) {v=e.fst; v_degree=fst_degree;} // if first endpoint is in reservoir
+      else if (find(r->vertices.begin(),r->vertices.end(),e.snd)!=r->vertices.end()) {v=e.snd; v_degree=snd_degree;} // if second endpoint is in reservoir
+      else continue;
+
+      if (v_degree<=max_d2+d1) {
+        r->edges.push_back(e);
+        BYTES+=sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+        RESERVOIR_BYTES+=sizeof(edge);
+      }
+
+      // check each query using this reservoir, v must be in its sample
+      int rank=-1;
+      for (vector<int>::iterator q_index=r->queries.begin(); q_index!=r->queries.end(); q_index++) {
+        query& q=queries[*q_index];
+        if (q.done || v_degree!=q.d2+d1) continue;
+        if (rank==-1) rank=sample_rank(v,*r);
+        if (rank>=q.size) continue; // v is not in this query's sample
+
+        // sufficient neighbourhood has been found for this query
+        for (vector<edge>::iterator i=r->edges.begin(); i!=r->edges.end(); i++) { // construct neighbourhood to be returned
+          if (i->fst==v) q.neighbourhood.push_back(i->snd);
+          else if (i->snd==v) q.neighbourhood.push_back(i->fst);
+        }
+        BYTES+=q.neighbourhood.size()*sizeof(vertex); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+        q.root=v; q.done=true; q.edges_checked=edge_count;
+        q.duration=chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now()-start).count();
+        remaining-=1;
+      }
+    }
+  }
+  cout<<"\rDONE                                   "<<endl;
+
+  // queries with no sucessful runs
+  long duration=chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now()-start).count();
+  for (vector<query>::iterator q=queries.begin(); q!=queries.end(); q++) {
+    if (q->done) continue;
+    q->done=true; q->edges_checked=edge_count; q->duration=duration;
+    q->neighbourhood.clear();
+  }
+
+  return edge_count;
+}
+
+/*--------------------*
+ * RESERVOIR SAMPLING *
+ *--------------------*/
+
+// create one reservoir for each distinct d1 over all runs of all queries
+void plan_reservoirs(int n, vector<query>& queries, vector<shared_reservoir>& reservoirs) {
+  map<int,int> d1_index; // d1 -> index in reservoirs
+  for (int q=0; q<queries.size(); q++) {
+    int c=queries[q].c, d=queries[q].d;
+    queries[q].size=ceil(log10(n)*pow(n,(double)1/c));
+    queries[q].d2=d/c;
+    queries[q].done=false; queries[q].edges_checked=0; queries[q].duration=0;
+    queries[q].neighbourhood.clear();
+
+    for (int j=0; j<c; j++) {
+      int d1=max(1,(j*d)/c); // calculate degree bounds for run
+      if (d1_index.count(d1)==0) {
+        d1_index[d1]=reservoirs.size();
+        shared_reservoir r; r.d1=d1; r.size=0;
+        reservoirs.push_back(r);
+      }
+      shared_reservoir& r=reservoirs[d1_index[d1]];
+      if (find(r.queries.begin(),r.queries.end(),q)==r.queries.end()) r.queries.push_back(q);
+      r.size=max(r.size,queries[q].size);
+    }
+  }
+  cout<<"runs share "<<reservoirs.size()<<" reservoirs"<<endl;
+}
+
+// bottom-k sampling, each vertex reaching d1 gets a random priority & the size lowest priorities are kept
+void update_reservoir(vertex n, shared_reservoir& reservoir, default_random_engine& generator) {
+  uniform_real_distribution<double> uniform_d(0,1);
+  double priority=uniform_d(generator);
+
+  if (reservoir.vertices.size()<reservoir.size) { // reservoir is not full
+    reservoir.vertices.push_back(n);
+    reservoir.priorities.push_back(priority);
+    BYTES+=sizeof(vertex)+sizeof(double); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+    RESERVOIR_BYTES+=sizeof(vertex)+sizeof(double);
+    return;
+  }
+
+  // reservoir is full, replace the highest priority if the new one is lower
+  int to_delete=max_element(reservoir.priorities.begin(),reservoir.priorities.end())-reservoir.priorities.begin();
+  if (reservoir.priorities[to_delete]<priority) return;
+
+  vertex to_delete_val=reservoir.vertices[to_delete];
+  reservoir.vertices[to_delete]=n;
+  reservoir.priorities[to_delete]=priority;
+  // NB No space change
+
+  // removes edges adjacent to vertex to be deleted (which are not adjacent to another vertex in the reservoir)
+  vector<edge>::iterator i=reservoir.edges.begin();
+  while (i!=reservoir.edges.end()) {
+    if ((i->fst==to_delete_val && find(reservoir.vertices.begin(),reservoir.vertices.end(),i->snd)==reservoir.vertices.end())
+      || (i->snd==to_delete_val && find(reservoir.vertices.begin(),reservoir.vertices.end(),i->fst)==reservoir.vertices.end())) { // edge not adjacent to another value in the reservoir
+      i=reservoir.edges.erase(i); // next edge
+      BYTES-=sizeof(edge);RESERVOIR_BYTES-=sizeof(edge);
+    } else i++; // next edge
+  }
+}
+
+// position of v in reservoir when ordered by priority
+int sample_rank(vertex v, shared_reservoir& reservoir) {
+  int index=find(reservoir.vertices.begin(),reservoir.vertices.end(),v)-reservoir.vertices.begin();
+  int rank=0;
+  for (vector<double>::iterator p=reservoir.priorities.begin(); p!=reservoir.priorities.end(); p++) if (*p<reservoir.priorities[index]) rank+=1;
+  return rank;
+}
+
+/*-----------*
+ * UTILITIES *
+ *-----------*/
+
+// parse ege from stream
+void parse_edge(string str, edge& e) {
+  string fst="",snd="";
+  bool after=false;
+
+  for (char& c:str) {
+    if (c==' ') { // seperator
+      after=true;
+    } else if (after) { // second id
+      snd+=c;
+    } else { // first id
+      fst+=c;
+    }
+  }
+
+  // Update edge values
+  e.fst=fst;e.snd=snd;
+}
+
+// return variance of values in a vector
+double variance(vector<int> vals) {
+  if (vals.size()<=1) return 0;
+  double var=0;
+  double mean=accumulate(vals.begin(),vals.end(),0)/vals.size();
+
+  for (vector<int>::iterator it=vals.begin(); it!=vals.end(); it++) var+=(*it-mean)*(*it-mean);
+  var/=(vals.size()-1);
+
+  return var;
+}
@@ -0,0 +1,431 @@
+/*-----------------*
+ * One pass c-approximation Streaming Algorithm for Neighbourhood Detection for Insertion-Only Graph Streams
+ *
+ * This implementation terminates early & runs R independent repetitions in one pass over the stream.
+ *  Edges are parsed once in batches, along with the degrees of their endpoints (the degree table doesn't depend on the seed so is shared),
+ *  then each batch is applied to every replica back-to-back (or split between threads), each replica has its own seeded generator.
+ *  Replicas which have terminated are skipped & reading stops once every replica has terminated.
+ *  Only I/O & parsing are shared, so a replica with seed s gives the same result as single_pass_insertion_stream (insertionStreams.cpp) seeded with s.
+ *  execute_test checks this against a copy of single_pass_insertion_stream whose generator is seeded once with s instead of with the time.
+ *
+ * Compile with -pthread for the threaded mode.
+ *-----------------*/
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+int DEGREE_BYTES; // space used to store degrees of vertices (shared by replicas)
+int BATCH_SIZE=10000; // # edges parsed before being applied to the replicas
+
+/*-----------------*
+ * DATA STRUCTURES *
+ *-----------------*/
+
+using vertex = string; // typemap vertex
+using time_point=chrono::high_resolution_clock::time_point;
+
+struct edge { // undirected edge
+  vertex fst;
+  vertex snd;
+};
+
+struct parsed_edge { // edge with the degrees of its endpoints after it has been added
+  edge e;
+  int fst_degree;
+  int snd_degree;
+};
+
+struct replica { // state of one repetition of the algorithm
+  default_random_engine generator;
+  vector<vector<vertex> > reservoirs; // one per run
+  vector<vector<edge> > edges; // one per run
+  vector<int> count; // counts the number of vertexs >=d1 for each run
+  bool done;
+  // results
+  int edges_checked;
+  vertex root;
+  vector<vertex> neighbourhood;
+  int bytes, max_bytes, reservoir_bytes, max_reservoir_bytes; // space used by this replica
+};
+
+/*-----------*
+* SIGNATURES *
+*------------*/
+
+void execute_test(int c_min, int c_max, int c_step, int reps, int num_threads, int d, int n, string file_name, string out_file);
+
+// main algorithm
+int replicated_insertion_stream(int c, int d, int n, ifstream& stream, vector<unsigned> seeds, vector<replica>& replicas, int num_threads); // returns # edges read
+void initialise_replica(int c, unsigned seed, replica& r);
+void apply_batch(int c, int d, int size, int first_edge, vector<parsed_edge>& batch, vector<replica>& replicas, int bot_replica, int top_replica);
+void apply_edge(int c, int d, int size, int edge_count, parsed_edge& p, replica& r);
+
+// reservoir sampling
+void update_reservoir(vertex n, int count, int size, vector<vertex>& reservoir, vector<edge>& edges, replica& r);
+
+// sequential reference (insertionStreams.cpp with a seeded generator)
+int single_pass_insertion_stream(int c, int d, int n, ifstream& stream, unsigned seed, vector<vertex>& neighbourhood, vertex& root);
+void update_reservoir(vertex n, int count, int size, vector<vertex>& reservoir, vector<edge>& edges, default_random_engine& generator);
+
+// utility
+void parse_edge(string str, edge& e);
+double variance(vector<int> vals);
+
+/*-----*
+* BODY *
+*------*/
+
+int main() {
+  string out_file_path;
+  int n,d,reps; string edge_file_path;
+
+  // c=runs, d/c=d2, n=# vertices, NOTE - set d=max degree, n=number of vertices
+  //n=12417; d=5948; reps=10; edge_file_path="../../data/gplus.edges"; // NOTE - # edges=1,179,613
+  //n=747; d=586; reps=10; edge_file_path="../../data/facebook.edges"; // NOTE - # edges=60,050
+
+  n=102100; d=104947; reps=10; edge_file_path="../../data/gplus_large.edges"; // NOTE - # edges=30,238,035
+  out_file_path="results_replicated_gplus_large.csv";
+  execute_test(41,100,1,reps,1,d,n,edge_file_path,out_file_path);
+
+  return 0;
+}
+
+// Runs reps sequential passes of single_pass_insertion_stream & one replicated pass with the same seeds for each c, writing results to a csv file
+void execute_test(int c_min, int c_max, int c_step, int reps, int num_threads, int d, int n, string file_name, string out_file) {
+  ofstream outfile(out_file);
+  outfile<<"name,"<<file_name<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"repetitions,"<<reps<<endl<<"threads,"<<num_threads<<endl<<"batch size,"<<BATCH_SIZE<<endl<<endl; // test details
+  outfile<<"c,sequential time (microseconds),replicated time (microseconds),mean max space (bytes),mean max reservoir space (bytes),degree space (bytes),mean edges checked,variance max space,variance reservoir space,varriance edges checked,successes,matching results"<<endl; // headers
+  vector<int> total_space, reservoir_space, edges_checked; // results of each run of c
+  default_random_engine seed_generator;
+  seed_generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+
+  for (int c=c_min;c<=c_max;c+=c_step) {
+    total_space.clear(); reservoir_space.clear(); edges_checked.clear();// reset for new run of c
+    vector<unsigned> seeds;
+    for (int i=0; i<reps; i++) seeds.push_back(seed_generator());
+
+    // sequential, one pass per repetition
+    cout<<c<<"/"<<c_max<<" sequential"<<endl; // output to terminal
+    vector<vector<vertex> > sequential_neighbourhoods(reps); vector<vertex> sequential_roots(reps); vector<int> sequential_edges_checked(reps);
+    time_point before=chrono::high_resolution_clock::now(); // time before execution
+    for (int i=0; i<reps; i++) {
+      ifstream stream(file_name); // file to read
+      sequential_edges_checked[i]=single_pass_insertion_stream(c,d,n,stream,seeds[i],sequential_neighbourhoods[i],sequential_roots[i]);
+      stream.close();
+    }
+    time_point after=chrono::high_resolution_clock::now(); // time after execution
+    auto sequential_duration=chrono::duration_cast<chrono::microseconds>(after-before).count();
+
+    // replicated, one pass for all repetitions
+    cout<<c<<"/"<<c_max<<" replicated"<<endl; // output to terminal
+    vector<replica> replicas;
+    before=chrono::high_resolution_clock::now(); // time before execution
+    ifstream stream(file_name); // file to read
+    replicated_insertion_stream(c,d,n,stream,seeds,replicas,num_threads);
+    stream.close();
+    after=chrono::high_resolution_clock::now(); // time after execution
+    auto replicated_duration=chrono::duration_cast<chrono::microseconds>(after-before).count();
+
+    int successes=0, matches=0;
+    for (int i=0; i<reps; i++) {
+      if (replicas[i].neighbourhood.size()!=0) successes+=1;
+      if (replicas[i].root==sequential_roots[i] && replicas[i].edges_checked==sequential_edges_checked[i] && replicas[i].neighbourhood==sequential_neighbourhoods[i]) matches+=1;
+      total_space.push_back(replicas[i].max_bytes); reservoir_space.push_back(replicas[i].max_reservoir_bytes); edges_checked.push_back(replicas[i].edges_checked);
+    }
+
+    int mean_total_space   =accumulate(total_space.begin(),total_space.end(),0)/total_space.size();
+    int mean_reservoir_space=accumulate(reservoir_space.begin(),reservoir_space.end(),0)/reservoir_space.size();
+    int mean_edges_checked =accumulate(edges_checked.begin(),edges_checked.end(),0)/edges_checked.size();
+
+    outfile<<c<<","<<sequential_duration<<","<<replicated_duration<<","<<mean_total_space<<","<<mean_reservoir_space<<","<<DEGREE_BYTES<<","<<mean_edges_checked<<","<<variance(total_space)<<","<<variance(reservoir_space)<<","<<variance(edges_checked)<<","<<successes<<","<<matches<<endl; // write values to file
+  }
+  outfile.close();
+}
+
+// perform reservoir sampling for one replica per seed
+// returns number of edges which are read
+int replicated_insertion_stream(int c, int d, int n, ifstream& stream, vector<unsigned> seeds, vector<replica>& replicas, int num_threads) {
+  int size=ceil(log10(n)*pow(n,(double)1/c));
+  int num_replicas=seeds.size();
+  replicas.assign(num_replicas,replica());
+  for (int i=0; i<num_replicas; i++) initialise_replica(c,seeds[i],replicas[i]);
+
+  string line; map<vertex,int> degrees; // these are shared for each replica
+  vector<parsed_edge> batch(BATCH_SIZE);
+  DEGREE_BYTES=sizeof(map<vertex,int>)+sizeof(vector<parsed_edge>)+BATCH_SIZE*sizeof(parsed_edge);
+
+  int edge_count=0, remaining=num_replicas;
+  while (remaining>0) { // While some replica hasn't terminated
+    // parse batch & calculate degrees
+    int batch_count=0;
+    while (batch_count<BATCH_SIZE && getline(stream,line)) {
+      parsed_edge& p=batch[batch_count];
+      parse_edge(line,p.e);
+
+      // increment degrees for each vertex
+      if (degrees.count(p.e.fst)) {
+        degrees[p.e.fst]+=1;
+      } else {
+        degrees[p.e.fst]=1;
+        DEGREE_BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*); // sizeof(void*)=size of pointer
+      }
+
+      if (degrees.count(p.e.snd)) {
+        degrees[p.e.snd]+=1;
+      } else {
+        degrees[p.e.snd]=1;
+        DEGREE_BYTES+=sizeof(vertex)+sizeof(int)+sizeof(void*); // sizeof(void*)=size of pointer
+      }
+      p.fst_degree=degrees[p.e.fst]; p.snd_degree=degrees[p.e.snd];
+      batch_count+=1;
+    }
+    if (batch_count==0) break; // stream is empty
+    batch.resize(batch_count);
+
+    // apply batch to each replica
+    if (num_threads<=1) apply_batch(c,d,size,edge_count,batch,replicas,0,num_replicas);
+    else {
+      vector<thread> threads;
+      int per_thread=ceil(num_replicas/(double)num_threads);
+      for (int t=0; t<num_threads; t++) {
+        int bot_replica=t*per_thread, top_replica=min(num_replicas,(t+1)*per_thread);
+        if (bot_replica>=top_replica) break;
+        threads.push_back(thread(apply_batch,c,d,size,edge_count,ref(batch),ref(replicas),bot_replica,top_replica));
+      }
+      for (vector<thread>::iterator t=threads.begin(); t!=threads.end(); t++) t->join();
+    }
+    edge_count+=batch_count;
+    batch.resize(BATCH_SIZE);
+    cout<<"\r"<<edge_count;
+
+    remaining=0;
+    for (int i=0; i<num_replicas; i++) if (!replicas[i].done) remaining+=1;
+  }
+  cout<<"\rDONE                         "<<endl;
+
+  // replicas with no sucessful runs
+  for (int i=0; i<num_replicas; i++) {
+    if (replicas[i].done) continue;
+    replicas[i].edges_checked=edge_count;
+    replicas[i].neighbourhood.clear();
+  }
+
+  return edge_count;
+}
+
+// prepare replica with its own generator
+void initialise_replica(int c, unsigned seed, replica& r) {
+  r.generator.seed(seed);
+  r.reservoirs.assign(c,vector<vertex>());
+  r.edges.assign(c,vector<edge>());
+  r.count.assign(c,0);
+  r.done=false; r.edges_checked=0; r.root=""; r.neighbourhood.clear();
+  r.bytes=sizeof(replica)+c*(sizeof(vector<vertex>)+sizeof(vector<edge>)+sizeof(int));
+  r.reservoir_bytes=c*(sizeof(vector<vertex>)+sizeof(vector<edge>));
+  r.max_bytes=r.bytes; r.max_reservoir_bytes=r.reservoir_bytes;
+}
+
+// apply every edge of batch to replicas [bot_replica,top_replica) which are still running
+void apply_batch(int c, int d, int size, int first_edge, vector<parsed_edge>& batch, vector<replica>& replicas, int bot_replica, int top_replica) {
+  for (int i=bot_replica; i<top_replica; i++) {
+    for (int k=0; k<batch.size() && !replicas[i].done; k++) apply_edge(c,d,size,first_edge+k+1,batch[k],replicas[i]);
+  }
+}
+
+// standard degree-restricted sampling for each run of one replica
+void apply_edge(int c, int d, int size, int edge_count, parsed_edge& p, replica& r) {
+  edge& e=p.e;
+  for (int j=0; j<c; j++) { // perform parallel runs
+    int d1=max(1,(j*d)/c), d2=d/c; // calculate degree bounds for run
+    vector<vertex>& reservoir=r.reservoirs[j]; vector<edge>& edges=r.edges[j];
+
+    // Consider adding first vertex to the reservoir
+    if (p.fst_degree==d1) {
+      r.count[j]+=1; // increment number of d1 degree vertexs
+      update_reservoir(e.fst,r.count[j],size,reservoir,edges,r); // possibly add value to reservoir
+    }
+
+    // Consider adding second vertex to the reservoir
+    if (p.snd_degree==d1) {
+      r.count[j]+=1; // increment number of d1 degree vertexs
+      update_reservoir(e.snd,r.count[j],size,reservoir,edges,r); // possibly add value to reservoir
+    }
+
+    vertex v; int v_degree;
+    if (find(reservoir.begin(),reservoir.end(),e.fst)!=reservoir.end()) {v=e.fst; v_degree=p.fst_degree;} // if first endpoint is in reservoir
+    else if (find(reservoir.begin(),reservoir.end(),e.snd)!=reservoir.end()) {v=e.snd; v_degree=p.snd_degree;} // if second endpoint is in reservoir
+    else continue;
+
+    if (v_degree<=d2+d1) {
+      edges.push_back(e);
+      r.bytes+=sizeof(edge); if (r.bytes>r.max_bytes) r.max_bytes=r.bytes;
+      r.reservoir_bytes+=sizeof(edge); if (r.reservoir_bytes>r.max_reservoir_bytes) r.max_reservoir_bytes=r.reservoir_bytes;
+    }
+    if (v_degree==d2+d1) { // sufficient neighbourhood has been found, this replica is done
+      for (vector<edge>::iterator i=edges.begin(); i!=edges.end(); i++) { // construct neighbourhood to be returned
+        if (i->fst==v) r.neighbourhood.push_back(i->snd);
+        else if (i->snd==v) r.neighbourhood.push_back(i->fst);
+      }
+      r.bytes+=r.neighbourhood.size()*sizeof(vertex); if (r.bytes>r.max_bytes) r.max_bytes=r.bytes;
+      r.root=v; r.edges_checked=edge_count; r.done=true;
+      return;
+    }
+  }
+}
+
+/*--------------------*
+ * RESERVOIR SAMPLING *
+ *--------------------*/
+
+void update_reservoir(vertex n, int count, int size, vector<vertex>& reservoir, vector<edge>& edges, replica& r) {
+  if (reservoir.size()<size) { // reservoir is not full
+    reservoir.push_back(n);
+    r.bytes+=sizeof(vertex); if (r.bytes>r.max_bytes) r.max_bytes=r.bytes;
+    r.reservoir_bytes+=sizeof(vertex); if (r.reservoir_bytes>r.max_reservoir_bytes) r.max_reservoir_bytes=r.reservoir_bytes;
+  } else { // reservoir is full
+    bernoulli_distribution bernoulli_d((float)size/(float)count);
+    if (bernoulli_d(r.generator)) { // if coin flip passes
+      uniform_int_distribution<unsigned long> uniform_d(0,size-1); // decide which vertex to delete
+      int to_delete=uniform_d(r.generator);
+
+      vertex to_delete_val=reservoir[to_delete];
+      reservoir.erase(reservoir.begin()+to_delete);
+      reservoir.push_back(n);
+      // NB No space change
+
+      // removes edges adjacent to vertex to be deleted (which are not adjacent to another vertex in the reservoir)
+      vector<edge>::iterator i=edges.begin();
+      while (i!=edges.end()) {
+        if ((i->fst==to_delete_val && find(reservoir.begin(),reservoir.end(),i->snd)==reservoir.end())
+          || (i->snd==to_delete_val && find(reservoir.begin(),reservoir.end(),i->fst)==reservoir.end())) { // edge not adjacent to another value in the reservoir
+          i=edges.erase(i); // next edge
+          r.bytes-=sizeof(edge); r.reservoir_bytes-=sizeof(edge);
+        } else i++; // next edge
+      }
+    }
+  }
+}
+
+/*----------------------*
+ * SEQUENTIAL REFERENCE *
+ *----------------------*/
+
+// single_pass_insertion_stream from insertionStreams.cpp, with one generator seeded with seed rather than the time
+// NB space isn't recorded, it is only used to check the replicas
+int single_pass_insertion_stream(int c, int d, int n, ifstream& stream, unsigned seed, vector<vertex>& neighbourhood, vertex& root) {
+  int size=ceil(log10(n)*pow(n,(double)1/c));
+  default_random_engine generator;
+  generator.seed(seed);
+
+  vector<vector<vertex> > reservoirs(c); vector<vector<edge> > edges(c); vector<int> count(c,0);
+  string line; edge e; map<vertex,int> degrees;
+
+  int edge_count=0;
+  while (getline(stream,line)) { // While stream is not empty
+    parse_edge(line,e);
+    edge_count+=1;
+    int degree_fst=++degrees[e.fst], degree_snd=++degrees[e.snd];
+
+    for (int j=0; j<c; j++) { // perform parallel runs
+      int d1=max(1,(j*d)/c), d2=d/c; // calculate degree bounds for run
+
+      if (degree_fst==d1) {
+        count[j]+=1;
+        update_reservoir(e.fst,count[j],size,reservoirs[j],edges[j],generator);
+      }
+      if (degree_snd==d1) {
+        count[j]+=1;
+        update_reservoir(e.snd,count[j],size,reservoirs[j],edges[j],generator);
+      }
+
+      vertex v; int v_degree;
+      if (find(reservoirs[j].begin(),reservoirs[j].end(),e.fst)!=reservoirs[j].end()) {v=e.fst; v_degree=degree_fst;}
+      else if (find(reservoirs[j].begin(),reservoirs[j].end(),e.snd)!=reservoirs[j].end()) {v=e.snd; v_degree=degree_snd;}
+      else continue;
+
+      if (v_degree<=d2+d1) edges[j].push_back(e);
+      if (v_degree==d2+d1) { // sufficient neighbourhood has been found, return it
+        for (vector<edge>::iterator i=edges[j].begin(); i!=edges[j].end(); i++) {
+          if (i->fst==v) neighbourhood.push_back(i->snd);
+          else if (i->snd==v) neighbourhood.push_back(i->fst);
+        }
+        root=v;
+        return edge_count;
+      }
+    }
+  }
+
+  // No sucessful runs
+  neighbourhood.clear(); root="";
+  return edge_count;
+}
+
+void update_reservoir(vertex n, int count, int size, vector<vertex>& reservoir, vector<edge>& edges, default_random_engine& generator) {
+  if (reservoir.size()<size) { // reservoir is not full
+    reservoir.push_back(n);
+  } else { // reservoir is full
+    bernoulli_distribution bernoulli_d((float)size/(float)count);
+    if (bernoulli_d(generator)) { // if coin flip passes
+      uniform_int_distribution<unsigned long> uniform_d(0,size-1); // decide which vertex to delete
+      int to_delete=uniform_d(generator);
+
+      vertex to_delete_val=reservoir[to_delete];
+      reservoir.erase(reservoir.begin()+to_delete);
+      reservoir.push_back(n);
+
+      // removes edges adjacent to vertex to be deleted (which are not adjacent to another vertex in the reservoir)
+      vector<edge>::iterator i=edges.begin();
+      while (i!=edges.end()) {
+        if ((i->fst==to_delete_val && find(reservoir.begin(),reservoir.end(),i->snd)==reservoir.end())
+          || (i->snd==to_delete_val && find(reservoir.begin(),reservoir.end(),i->fst)==reservoir.end())) i=edges.erase(i);
+        else i++;
+      }
+    }
+  }
+}
+
+/*-----------*
+ * UTILITIES *
+ *-----------*/
+
+// parse ege from stream
+void parse_edge(string str, edge& e) {
+  string fst="",snd="";
+  bool after=false;
+
+  for (char& c:str) {
+    if (c==' ') { // seperator
+      after=true;
+    } else if (after) { // second id
+      snd+=c;
+    } else { // first id
+      fst+=c;
+    }
+  }
+
+  // Update edge values
+  e.fst=fst;e.snd=snd;
+}
+
+// return variance of values in a vector
+double variance(vector<int> vals) {
+  if (vals.size()<=1) return 0;
+  double var=0;
+  double mean=accumulate(vals.begin(),vals.end(),0)/vals.size();
+
+  for (vector<int>::iterator it=vals.begin(); it!=vals.end(); it++) var+=(*it-mean)*(*it-mean);
+  var/=(vals.size()-1);
+
+  return var;
+}
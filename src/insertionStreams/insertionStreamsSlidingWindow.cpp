@@ -0,0 +1,464 @@
+/*-----------------*
+ * One pass c-approximation Streaming Algorithm for Neighbourhood Detection for Insertion-Only Graph Streams over a Sliding Window
+ *
+ * This implementation terminates after the first sufficiently large neighbourhood is found, considering only edges in the last W time units.
+ *  Edges are "v1 v2" or "v1 v2 t" where t is an integer timestamp (e.g. seconds), timestamps must be non-decreasing.
+ *  If there is no timestamp column the edge index is used, so W is then a number of edges.
+ *
+ * Degrees are estimated with an exponential histogram (Datar et al.) per vertex, with relative error at most 1/k.
+ * Each run keeps a bottom-size priority sample of the vertices whose windowed degree has reached d1 (a reservoir sample over the window),
+ *  vertices whose windowed degree falls back below d1 are evicted, & stored edges are expired as they leave the window.
+ *  Candidates which are not sampled keep their priority while their windowed degree stays >= d1, & the lowest is promoted when a
+ *  sampled vertex is evicted, so at each sweep the sample is uniform over the current candidates.
+ *
+ * SPACE (m_W = # edges in the window, m_W<=W for edge windows)
+ *  degree histograms - at most min(n,2m_W) vertices, each with O(k log(m_W)) buckets
+ *  reservoirs        - c*size vertices, size=log10(n)*n^(1/c)
+ *  waiting candidates - vertices with windowed degree>=d1 outside the sample, at most 2m_W/d1 per run (run 0 has d1=1 so is bounded as the histograms)
+ *  edge buckets      - at most d2=d/c edges per reservoir vertex, so c*size*d2 edges
+ *  NB vertices whose histograms have emptied are only removed every SWEEP_INTERVAL edges, so they can linger for that long
+ *-----------------*/
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int BYTES; // space used atm
+int RESERVOIR_BYTES; // space used by reservoirs atm
+int DEGREE_BYTES; // space used to store degrees of vertices atm
+int MAX_BYTES; // max space used at any time
+int MAX_RESERVOIR_BYTES; // max space used by reservoirs
+int MAX_DEGREE_BYTES; // max space used by degree histograms
+int SWEEP_INTERVAL=10000; // # edges between removing expired vertices
+
+/*-----------------*
+ * DATA STRUCTURES *
+ *-----------------*/
+
+using vertex = string; // typemap vertex
+using time_point=chrono::high_resolution_clock::time_point;
+
+struct edge { // undirected edge
+  vertex fst;
+  vertex snd;
+  long time; // timestamp (or index of edge)
+};
+
+struct bucket { // bucket of an exponential histogram
+  long time; // time of most recent edge in bucket
+  int size; // # edges in bucket (power of 2)
+};
+
+struct exp_histogram { // estimates # edges in the window incident to a vertex
+  deque<bucket> buckets; // newest at front
+  int total; // sum of bucket sizes
+};
+
+struct window_reservoir { // sample of vertices with windowed degree>=d1 & edges incident to them
+  vector<vertex> vertices;
+  vector<double> priorities; // keep vertices with lowest priorities
+  deque<edge> edges; // in time order, fst is the sampled vertex the edge was stored for
+  map<vertex,int> collected; // # edges in edges for each vertex in sample
+  map<vertex,double> waiting; // priority of each vertex with windowed degree>=d1 which is not in sample
+};
+
+/*-----------*
+* SIGNATURES *
+*------------*/
+
+void execute_test(int c, vector<long> windows, int k, int reps, int d, int n, string file_name, string out_file); // each window is tested reps times
+
+// main algorithm
+int single_pass_sliding_window_stream(int c, int d, int n, long window, int k, ifstream& stream, vector<vertex>& neighbourhood, vertex& root);
+
+// exponential histogram
+void eh_insert(exp_histogram& h, long time, int k);
+void eh_expire(exp_histogram& h, long now, long window);
+int eh_estimate(exp_histogram& h);
+void sweep_degrees(long now, long window, map<vertex,exp_histogram>& degrees);
+
+// windowed reservoir sampling
+void update_reservoir(vertex n, int size, window_reservoir& reservoir, default_random_engine& generator);
+void remove_from_reservoir(int index, window_reservoir& reservoir);
+void expire_edges(long now, long window, window_reservoir& reservoir);
+void evict_low_degree(long now, long window, int d1, window_reservoir& reservoir, map<vertex,exp_histogram>& degrees);
+void add_to_reservoir(vertex n, double priority, window_reservoir& reservoir);
+void add_to_waiting(vertex n, double priority, window_reservoir& reservoir);
+void promote_waiting(int size, window_reservoir& reservoir);
+
+// utility
+void parse_edge(string str, long index, edge& e);
+double variance(vector<int> vals);
+
+/*-----*
+* BODY *
+*------*/
+
+int main() {
+  string out_file_path;
+  int n,d,reps; string edge_file_path;
+  int c=4, k=4; // k -> relative error of degrees at most 1/k
+  vector<long> windows;
+
+  // c=runs, d/c=d2, n=# vertices, NOTE - set d=max degree within a window, n=number of vertices
+  //n=52; d=35; reps=10; edge_file_path="../../data/facebook_small.edges"; // NOTE - # edges=292
+  //n=747; d=586; reps=10; edge_file_path="../../data/facebook.edges"; // NOTE - # edges=60,050
+
+  n=12417; d=5948; reps=10; edge_file_path="../../data/gplus.edges"; // NOTE - # edges=1,179,613
+  for (long w=10000; w<=1280000; w*=2) windows.push_back(w); // last W edges
+  out_file_path="results_sliding_window_gplus.csv";
+  execute_test(c,windows,k,reps,d,n,edge_file_path,out_file_path);
+
+  return 0;
+}
+
+// Runs algorithm multiple times for each window size, writing results to a csv file
+void execute_test(int c, vector<long> windows, int k, int reps, int d, int n, string file_name, string out_file) {
+  ofstream outfile(out_file);
+  outfile<<"name,"<<file_name<<endl<<"n,"<<n<<endl<<"d,"<<d<<endl<<"c,"<<c<<endl<<"k,"<<k<<endl<<"repetitions,"<<reps<<endl<<endl; // test details
+  outfile<<"window,time (microseconds),mean max space (bytes),mean max reservoir space (bytes),mean max degree space (bytes),mean edges checked,variance time, variance max space,variance reservoir space, variance degree space,varriance edges checked,successes"<<endl; // headers
+  vector<vertex> neighbourhood; vertex root; // variables for returned values
+  vector<int> times, total_space, reservoir_space, degree_space, edges_checked; // results of each window
+  int successes;
+  for (vector<long>::iterator w=windows.begin(); w!=windows.end(); w++) {
+    successes=0;
+    times.clear(); total_space.clear(); reservoir_space.clear(); degree_space.clear(); edges_checked.clear();// reset for new window
+    for (int i=0;i<reps;i++) {
+      cout<<"("<<i<<"/"<<reps<<") W="<<*w<<endl; // output to terminal
+
+      // reset values
+      BYTES=0; RESERVOIR_BYTES=0; DEGREE_BYTES=0; MAX_BYTES=0; MAX_RESERVOIR_BYTES=0; MAX_DEGREE_BYTES=0;
+      neighbourhood.clear(); vertex* p=&root; p=nullptr;
+      ifstream stream(file_name); // file to read
+
+      time_point before=chrono::high_resolution_clock::now(); // time before execution
+      edges_checked.push_back(single_pass_sliding_window_stream(c,d,n,*w,k,stream,neighbourhood,root));
+      time_point after=chrono::high_resolution_clock::now(); // time after execution
+
+      cout<<root<<endl;
+      cout<<neighbourhood.size()<<"("<<d/c<<")"<<endl<<endl;
+
+      stream.close();
+
+      if (neighbourhood.size()!=0) successes+=1;
+
+      auto duration = chrono::duration_cast<chrono::microseconds>(after-before).count(); // time passed
+      times.push_back(duration); total_space.push_back(MAX_BYTES); reservoir_space.push_back(MAX_RESERVOIR_BYTES); degree_space.push_back(MAX_DEGREE_BYTES);
+    }
+    int mean_duration      =accumulate(times.begin(),times.end(),0)/times.size();
+    int mean_total_space   =accumulate(total_space.begin(),total_space.end(),0)/total_space.size();
+    int mean_reservoir_space=accumulate(reservoir_space.begin(),reservoir_space.end(),0)/reservoir_space.size();
+    int mean_degree_space  =accumulate(degree_space.begin(),degree_space.end(),0)/degree_space.size();
+    int mean_edges_checked =accumulate(edges_checked.begin(),edges_checked.end(),0)/edges_checked.size();
+
+    double variance_duration      =variance(times);
+    double variance_total_space   =variance(total_space);
+    double variance_reservoir_space=variance(reservoir_space);
+    double variance_degree_space  =variance(degree_space);
+    double variance_edges_checked =variance(edges_checked);
+
+    outfile<<*w<<","<<mean_duration<<","<<mean_total_space<<","<<mean_reservoir_space<<","<<mean_degree_space<<","<<mean_edges_checked<<","<<variance_duration<<","<<variance_total_space<<","<<variance_reservoir_space<<","<<variance_degree_space<<","<<variance_edges_checked<<","<<successes<<endl; // write values to file
+  }
+  outfile.close();
+}
+
+// perform windowed reservoir sampling
+// returns number of edges which are read
+int single_pass_sliding_window_stream(int c, int d, int n, long window, int k, ifstream& stream, vector<vertex>& neighbourhood, vertex& root) {
+  int size=ceil(log10(n)*pow(n,(double)1/c));
+
+  // initalise reservoir for each parallel run
+  window_reservoir* reservoirs[c];
+  for (int i=0; i<c; i++) reservoirs[i]=new window_reservoir;
+  BYTES+=c*sizeof(window_reservoir);
+  RESERVOIR_BYTES+=c*sizeof(window_reservoir);
+
+  default_random_engine generator;
+  generator.seed(chrono::system_clock::now().time_since_epoch().count()); // seed with current time
+
+  string line; edge e; map<vertex,exp_histogram> degrees; // these are shared for each run
+  BYTES+=sizeof(string)+sizeof(edge)+sizeof(map<vertex,exp_histogram>)+sizeof(default_random_engine);
+  DEGREE_BYTES+=sizeof(map<vertex,exp_histogram>);
+
+  int edge_count=0;
+  while (getline(stream,line)) { // While stream is not empty
+    parse_edge(line,edge_count,e);
+    edge_count+=1;
+    if (edge_count%10000==0) cout<<"\r"<<edge_count;
+
+    // periodically remove vertices with no edges in window & reservoir vertices which have fallen below d1
+    if (edge_count%SWEEP_INTERVAL==0) {
+      sweep_degrees(e.time,window,degrees);
+      for (int j=0; j<c; j++) {
+        evict_low_degree(e.time,window,max(1,(j*d)/c),*reservoirs[j],degrees);
+        promote_waiting(size,*reservoirs[j]);
+      }
+    }
+
+    // update windowed degrees for each vertex, estimates before the update are kept to spot vertices crossing d1
+    vertex endpoints[2]={e.fst,e.snd};
+    int prev_estimates[2], estimates[2];
+    for (int x=0; x<2; x++) {
+      if (degrees.count(endpoints[x])==0) {
+        degrees[endpoints[x]].total=0;
+        BYTES+=sizeof(vertex)+sizeof(exp_histogram)+sizeof(void*); // sizeof(void*)=size of pointer
+        DEGREE_BYTES+=sizeof(vertex)+sizeof(exp_histogram)+sizeof(void*);
+      }
+      exp_histogram& h=degrees[endpoints[x]];
+      eh_expire(h,e.time,window);
+      prev_estimates[x]=eh_estimate(h);
+      eh_insert(h,e.time,k);
+      estimates[x]=eh_estimate(h);
+    }
+    if (DEGREE_BYTES>MAX_DEGREE_BYTES) MAX_DEGREE_BYTES=DEGREE_BYTES;
+    if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+
+    for (int j=0; j<c; j++) { // perform parallel runs
+      int d1=max(1,(j*d)/c), d2=d/c; // calculate degree bounds for run
+      window_reservoir& reservoir=*reservoirs[j];
+      expire_edges(e.time,window,reservoir);
+
+      for (int x=0; x<2; x++) {
+        // Consider adding endpoint to the reservoir
+        if (prev_estimates[x]<d1 && estimates[x]>=d1 && reservoir.collected.count(endpoints[x])==0 && reservoir.waiting.count(endpoints[x])==0) {
+          update_reservoir(endpoints[x],size,reservoir,generator); // possibly add value to reservoir
+        }
+      }
+
+      for (int x=0; x<2; x++) {
+        map<vertex,int>::iterator it=reservoir.collected.find(endpoints[x]);
+        if (it==reservoir.collected.end()) continue; // endpoint not in reservoir
+
+        if (it->second<d2) {
+          edge stored={endpoints[x],endpoints[1-x],e.time};
+          reservoir.edges.push_back(stored);
+          it->second+=1;
+          BYTES+=sizeof(edge); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+          RESERVOIR_BYTES+=sizeof(edge); if (RESERVOIR_BYTES>MAX_RESERVOIR_BYTES) MAX_RESERVOIR_BYTES=RESERVOIR_BYTES;
+        }
+        if (it->second>=d2) { // sufficient neighbourhood has been found in the window, return it
+          cout<<endl<<"*"<<estimates[x]<<endl;
+          for (deque<edge>::iterator i=reservoir.edges.begin(); i!=reservoir.edges.end(); i++) { // construct neighbourhood to be returned
+            if (i->fst==endpoints[x]) neighbourhood.push_back(i->snd);
+          }
+          BYTES+=neighbourhood.size()*sizeof(vertex); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+          root=endpoints[x];
+          for (int i=0; i<c; i++) delete reservoirs[i];
+          return edge_count;
+        }
+        break; // edge only stored once per run
+      }
+    }
+
+  }
+  cout<<"\rDONE                         "<<endl;
+
+  // No sucessful runs
+  for (int i=0; i<c; i++) delete reservoirs[i];
+  neighbourhood.clear();
+  vertex* p=&root;
+  p=nullptr;
+
+  return edge_count;
+}
+
+/*-----------------------*
+ * EXPONENTIAL HISTOGRAM *
+ *-----------------------*/
+
+// add an edge at time to the histogram, merging the two oldest buckets of a size whenever there are more than k/2+1 of that size
+void eh_insert(exp_histogram& h, long time, int k) {
+  int max_per_size=k/2+1;
+  bucket b={time,1};
+  h.buckets.push_front(b);
+  h.total+=1;
+  BYTES+=sizeof(bucket); DEGREE_BYTES+=sizeof(bucket);
+
+  int i=0;
+  while (i<h.buckets.size()) {
+    int size=h.buckets[i].size, j=i;
+    while (j<h.buckets.size() && h.buckets[j].size==size) j++; // [i,j) have the same size
+    if (j-i<=max_per_size) break; // larger buckets are unaffected
+
+    // merge two oldest of this size, keeping the time of the more recent one
+    h.buckets[j-2].size*=2;
+    h.buckets.erase(h.buckets.begin()+(j-1));
+    BYTES-=sizeof(bucket); DEGREE_BYTES-=sizeof(bucket);
+    i=j-2; // merged bucket may cause larger size to overflow
+  }
+}
+
+// remove buckets whose most recent edge has left the window
+void eh_expire(exp_histogram& h, long now, long window) {
+  while (h.buckets.size()>0 && h.buckets.back().time<=now-window) {
+    h.total-=h.buckets.back().size;
+    h.buckets.pop_back();
+    BYTES-=sizeof(bucket); DEGREE_BYTES-=sizeof(bucket);
+  }
+}
+
+// estimate # edges in window, only the oldest bucket may be partially expired so count half of it
+int eh_estimate(exp_histogram& h) {
+  if (h.buckets.size()==0) return 0;
+  return h.total-h.buckets.back().size/2;
+}
+
+// remove vertices which have no edges left in the window
+void sweep_degrees(long now, long window, map<vertex,exp_histogram>& degrees) {
+  map<vertex,exp_histogram>::iterator it=degrees.begin();
+  while (it!=degrees.end()) {
+    eh_expire(it->second,now,window);
+    if (it->second.buckets.size()==0) {
+      it=degrees.erase(it);
+      BYTES-=sizeof(vertex)+sizeof(exp_histogram)+sizeof(void*);
+      DEGREE_BYTES-=sizeof(vertex)+sizeof(exp_histogram)+sizeof(void*);
+    } else it++;
+  }
+}
+
+/*-----------------------------*
+ * WINDOWED RESERVOIR SAMPLING *
+ *-----------------------------*/
+
+// priority sampling, each candidate gets a random priority & the size lowest priorities are kept
+// a candidate which is not kept (or is displaced) waits with its priority, so it can be promoted once a sampled vertex is evicted
+void update_reservoir(vertex n, int size, window_reservoir& reservoir, default_random_engine& generator) {
+  uniform_real_distribution<double> uniform_d(0,1);
+  double priority=uniform_d(generator);
+
+  if (reservoir.vertices.size()>=size) { // reservoir is full, replace the highest priority if the new one is lower
+    int max_index=max_element(reservoir.priorities.begin(),reservoir.priorities.end())-reservoir.priorities.begin();
+    if (reservoir.priorities[max_index]<priority) {
+      add_to_waiting(n,priority,reservoir);
+      return;
+    }
+    add_to_waiting(reservoir.vertices[max_index],reservoir.priorities[max_index],reservoir);
+    remove_from_reservoir(max_index,reservoir);
+  }
+  add_to_reservoir(n,priority,reservoir);
+}
+
+// add vertex to sample with no stored edges
+void add_to_reservoir(vertex n, double priority, window_reservoir& reservoir) {
+  reservoir.vertices.push_back(n);
+  reservoir.priorities.push_back(priority);
+  reservoir.collected[n]=0;
+  BYTES+=sizeof(vertex)+sizeof(double)+sizeof(vertex)+sizeof(int)+sizeof(void*); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+  RESERVOIR_BYTES+=sizeof(vertex)+sizeof(double)+sizeof(vertex)+sizeof(int)+sizeof(void*); if (RESERVOIR_BYTES>MAX_RESERVOIR_BYTES) MAX_RESERVOIR_BYTES=RESERVOIR_BYTES;
+}
+
+void add_to_waiting(vertex n, double priority, window_reservoir& reservoir) {
+  reservoir.waiting[n]=priority;
+  BYTES+=sizeof(vertex)+sizeof(double)+sizeof(void*); if (BYTES>MAX_BYTES) MAX_BYTES=BYTES;
+  RESERVOIR_BYTES+=sizeof(vertex)+sizeof(double)+sizeof(void*); if (RESERVOIR_BYTES>MAX_RESERVOIR_BYTES) MAX_RESERVOIR_BYTES=RESERVOIR_BYTES;
+}
+
+// fill free slots of the sample with the lowest priority waiting candidates, whose edges are collected from now on
+void promote_waiting(int size, window_reservoir& reservoir) {
+  while (reservoir.vertices.size()<size && reservoir.waiting.size()>0) {
+    map<vertex,double>::iterator lowest=min_element(reservoir.waiting.begin(),reservoir.waiting.end(),[](const pair<const vertex,double>& x, const pair<const vertex,double>& y) {return x.second<y.second;});
+    add_to_reservoir(lowest->first,lowest->second,reservoir);
+    reservoir.waiting.erase(lowest);
+    BYTES-=sizeof(vertex)+sizeof(double)+sizeof(void*);
+    RESERVOIR_BYTES-=sizeof(vertex)+sizeof(double)+sizeof(void*);
+  }
+}
+
+// remove vertex from reservoir along with the edges stored for it
+void remove_from_reservoir(int index, window_reservoir& reservoir) {
+  vertex to_delete_val=reservoir.vertices[index];
+  reservoir.vertices.erase(reservoir.vertices.begin()+index);
+  reservoir.priorities.erase(reservoir.priorities.begin()+index);
+  reservoir.collected.erase(to_delete_val);
+  BYTES-=sizeof(vertex)+sizeof(double)+sizeof(vertex)+sizeof(int)+sizeof(void*);
+  RESERVOIR_BYTES-=sizeof(vertex)+sizeof(double)+sizeof(vertex)+sizeof(int)+sizeof(void*);
+
+  deque<edge>::iterator i=reservoir.edges.begin();
+  while (i!=reservoir.edges.end()) {
+    if (i->fst==to_delete_val) {
+      i=reservoir.edges.erase(i);
+      BYTES-=sizeof(edge); RESERVOIR_BYTES-=sizeof(edge);
+    } else i++; // next edge
+  }
+}
+
+// remove stored edges which have left the window
+void expire_edges(long now, long window, window_reservoir& reservoir) {
+  while (reservoir.edges.size()>0 && reservoir.edges.front().time<=now-window) {
+    edge& old=reservoir.edges.front();
+    reservoir.collected[old.fst]-=1; // edges are removed when their vertex leaves the reservoir, so fst is still sampled
+    reservoir.edges.pop_front();
+    BYTES-=sizeof(edge); RESERVOIR_BYTES-=sizeof(edge);
+  }
+}
+
+// remove reservoir vertices & waiting candidates whose windowed degree has dropped below d1
+void evict_low_degree(long now, long window, int d1, window_reservoir& reservoir, map<vertex,exp_histogram>& degrees) {
+  auto windowed_degree=[&](vertex v) {
+    map<vertex,exp_histogram>::iterator it=degrees.find(v);
+    if (it==degrees.end()) return 0;
+    eh_expire(it->second,now,window);
+    return eh_estimate(it->second);
+  };
+  int i=0;
+  while (i<reservoir.vertices.size()) {
+    if (windowed_degree(reservoir.vertices[i])<d1) remove_from_reservoir(i,reservoir);
+    else i++;
+  }
+  map<vertex,double>::iterator it=reservoir.waiting.begin();
+  while (it!=reservoir.waiting.end()) {
+    if (windowed_degree(it->first)<d1) {
+      it=reservoir.waiting.erase(it);
+      BYTES-=sizeof(vertex)+sizeof(double)+sizeof(void*);
+      RESERVOIR_BYTES-=sizeof(vertex)+sizeof(double)+sizeof(void*);
+    } else it++;
+  }
+}
+
+/*-----------*
+ * UTILITIES *
+ *-----------*/
+
+// parse edge from string "v1 v2" or "v1 v2 t", if there is no timestamp the index of the edge is used
+void parse_edge(string str, long index, edge& e) {
+  string fst="",snd="",time="";
+  int spaces=0;
+
+  for (char& c:str) {
+    if (c==' ') { // seperator
+      spaces+=1;
+    } else if (spaces==0) { // first id
+      fst+=c;
+    } else if (spaces==1) { // second id
+      snd+=c;
+    } else { // timestamp
+      time+=c;
+    }
+  }
+
+  // Update edge values
+  e.fst=fst;e.snd=snd;
+  e.time=(time=="") ? index : stol(time);
+}
+
+// return variance of values in a vector
+double variance(vector<int> vals) {
+  if (vals.size()<=1) return 0;
+  double var=0;
+  double mean=accumulate(vals.begin(),vals.end(),0)/vals.size();
+
+  for (vector<int>::iterator it=vals.begin(); it!=vals.end(); it++) var+=(*it-mean)*(*it-mean);
+  var/=(vals.size()-1);
+
+  return var;
+}